@@ -0,0 +1,382 @@
+#include "AdvTable.h"
+#include <string.h>
+
+// AD types (Bluetooth Assigned Numbers)
+#define AD_UUID16_PARTIAL   0x02
+#define AD_UUID16_COMPLETE  0x03
+#define AD_UUID32_PARTIAL   0x04
+#define AD_UUID32_COMPLETE  0x05
+#define AD_UUID128_PARTIAL  0x06
+#define AD_UUID128_COMPLETE 0x07
+#define AD_NAME_SHORT       0x08
+#define AD_NAME_COMPLETE    0x09
+#define AD_MANUFACTURER     0xFF
+
+int8_t AdvEntry::rssiMean() const {
+    if (count == 0) return 0;
+    int32_t c = (int32_t)count;
+    // bulatkan ke terdekat (rssiSum negatif)
+    return (int8_t)((rssiSum - c / 2) / c);
+}
+
+bool advParsePayload(const uint8_t* payload, size_t len, AdvSample& out) {
+    out.mfg       = nullptr;
+    out.mfgLen    = 0;
+    out.name      = nullptr;
+    out.nameLen   = 0;
+    out.uuidCount = 0;
+
+    size_t i = 0;
+    while (i < len) {
+        uint8_t adLen = payload[i];
+        if (adLen == 0) break;                 // padding
+        if (i + 1 + adLen > len) return false;
+
+        uint8_t        type = payload[i + 1];
+        const uint8_t* data = &payload[i + 2];
+        uint8_t        dlen = adLen - 1;
+
+        switch (type) {
+            case AD_MANUFACTURER:
+                out.mfg    = data;
+                out.mfgLen = dlen > ADV_MFG_MAX ? ADV_MFG_MAX : dlen;
+                break;
+
+            case AD_NAME_COMPLETE:
+            case AD_NAME_SHORT:
+                if (out.name && type == AD_NAME_SHORT) break;   // complete menang
+                out.name    = data;
+                out.nameLen = dlen > ADV_NAME_MAX ? ADV_NAME_MAX : dlen;
+                break;
+
+            case AD_UUID16_PARTIAL:
+            case AD_UUID16_COMPLETE:
+            case AD_UUID32_PARTIAL:
+            case AD_UUID32_COMPLETE:
+            case AD_UUID128_PARTIAL:
+            case AD_UUID128_COMPLETE: {
+                uint8_t ulen = (type <= AD_UUID16_COMPLETE) ? 2
+                             : (type <= AD_UUID32_COMPLETE) ? 4 : 16;
+                for (uint8_t off = 0; off + ulen <= dlen && out.uuidCount < ADV_UUID_MAX; off += ulen) {
+                    AdvUuid& u = out.uuids[out.uuidCount++];
+                    u.len = ulen;
+                    memcpy(u.val, data + off, ulen);
+                }
+                break;
+            }
+
+            default:
+                break;
+        }
+        i += 1 + adLen;
+    }
+    return true;
+}
+
+// ======================================================================
+//  TABEL
+// ======================================================================
+static uint32_t addrHash(const uint8_t addr[6], uint8_t type) {
+    uint32_t h = 2166136261u;
+    for (uint8_t i = 0; i < 6; ++i) {
+        h ^= addr[i];
+        h *= 16777619u;
+    }
+    h ^= type;
+    h *= 16777619u;
+    return h;
+}
+
+void AdvTable::clear() {
+    memset(entries_, 0, sizeof(entries_));
+    used_  = 0;
+    stats_ = AdvStats{};
+}
+
+static uint16_t homeSlot(const AdvEntry& e) {
+    return (uint16_t)(addrHash(e.addr, e.addrType) & (ADV_TABLE_CAPACITY - 1));
+}
+
+// Hapus slot pos lalu geser entry sesudahnya yang probe-nya melewati pos,
+// supaya rantai linear probing tetap utuh tanpa tombstone.
+void AdvTable::removeAt(uint16_t pos) {
+    const uint16_t mask = ADV_TABLE_CAPACITY - 1;
+    uint16_t hole = pos;
+    uint16_t j    = pos;
+
+    entries_[hole].used = 0;
+    used_--;
+
+    for (;;) {
+        j = (j + 1) & mask;
+        if (!entries_[j].used) break;
+
+        // entry j boleh tetap kalau home-nya ada di (hole, j] (siklis)
+        uint16_t home = homeSlot(entries_[j]);
+        bool stay = (hole <= j) ? (hole < home && home <= j)
+                                : (hole < home || home <= j);
+        if (stay) continue;
+
+        entries_[hole] = entries_[j];
+        entries_[j].used = 0;
+        hole = j;
+    }
+}
+
+void AdvTable::evictOldest() {
+    uint16_t oldest = ADV_TABLE_CAPACITY;
+    for (uint16_t i = 0; i < ADV_TABLE_CAPACITY; ++i) {
+        if (!entries_[i].used) continue;
+        // selisih terhadap slot terlama sekarang → aman saat millis() wrap
+        if (oldest == ADV_TABLE_CAPACITY ||
+            (int32_t)(entries_[i].lastSeenMs - entries_[oldest].lastSeenMs) < 0) {
+            oldest = i;
+        }
+    }
+    if (oldest == ADV_TABLE_CAPACITY) return;
+    removeAt(oldest);
+    stats_.evicted++;
+}
+
+bool AdvTable::update(const AdvSample& s, uint32_t nowMs) {
+    const uint16_t mask = ADV_TABLE_CAPACITY - 1;
+    uint16_t pos = (uint16_t)(addrHash(s.addr, s.addrType) & mask);
+
+    AdvEntry* e = nullptr;
+    for (int attempt = 0; attempt < 2 && !e; ++attempt) {
+        for (uint16_t probe = 0; probe < ADV_TABLE_CAPACITY; ++probe) {
+            AdvEntry& cand = entries_[(pos + probe) & mask];
+            if (!cand.used) {
+                // slot kosong pertama → device baru (delete pakai backward
+                // shift, jadi tidak ada lubang di tengah rantai)
+                if (used_ >= ADV_TABLE_CAPACITY - 1) break;   // sisakan 1 slot kosong
+                e = &cand;
+                memset(e, 0, sizeof(*e));
+                e->used     = 1;
+                e->addrType = s.addrType;
+                memcpy(e->addr, s.addr, 6);
+                used_++;
+                break;
+            }
+            if (cand.addrType == s.addrType && memcmp(cand.addr, s.addr, 6) == 0) {
+                e = &cand;
+                break;
+            }
+        }
+        // device baru, tabel penuh → ganti yang paling lama, probe ulang
+        if (!e && attempt == 0) evictOldest();
+    }
+
+    if (!e) {
+        stats_.tableFull++;
+        return false;
+    }
+
+    if (e->count == 0) {
+        e->rssiMin = s.rssi;
+        e->rssiMax = s.rssi;
+    }
+    e->count++;
+    e->rssiSum += s.rssi;
+    if (s.rssi < e->rssiMin) e->rssiMin = s.rssi;
+    if (s.rssi > e->rssiMax) e->rssiMax = s.rssi;
+    e->lastSeenMs = nowMs;
+
+    if (s.mfg) {
+        e->mfgLen = s.mfgLen;
+        memcpy(e->mfg, s.mfg, s.mfgLen);
+    }
+    if (s.uuidCount) {
+        e->uuidCount = s.uuidCount;
+        memcpy(e->uuids, s.uuids, sizeof(AdvUuid) * s.uuidCount);
+    }
+    if (s.name) {
+        e->nameLen = s.nameLen;
+        memcpy(e->name, s.name, s.nameLen);
+    }
+
+    stats_.processed++;
+    return true;
+}
+
+void AdvTable::beginWindow(uint32_t nowMs, uint32_t expireMs) {
+    uint16_t i = 0;
+    while (i < ADV_TABLE_CAPACITY) {
+        AdvEntry& e = entries_[i];
+        if (e.used && nowMs - e.lastSeenMs >= expireMs) {
+            removeAt(i);
+            continue;   // slot i bisa terisi entry hasil geser → cek lagi
+        }
+        e.count   = 0;
+        e.rssiSum = 0;
+        ++i;
+    }
+    stats_ = AdvStats{};
+}
+
+uint16_t AdvTable::sortedByRssi(uint16_t* idx, uint16_t maxIdx) const {
+    uint16_t n = 0;
+    for (uint16_t i = 0; i < ADV_TABLE_CAPACITY && n < maxIdx; ++i) {
+        if (entries_[i].used && entries_[i].count) idx[n++] = i;
+    }
+
+    // insertion sort, n kecil (≤ 64)
+    for (uint16_t i = 1; i < n; ++i) {
+        uint16_t v    = idx[i];
+        int8_t   mean = entries_[v].rssiMean();
+        uint16_t j    = i;
+        while (j > 0 && entries_[idx[j - 1]].rssiMean() < mean) {
+            idx[j] = idx[j - 1];
+            --j;
+        }
+        idx[j] = v;
+    }
+    return n;
+}
+
+// ======================================================================
+//  DUMP BINER
+// ======================================================================
+uint16_t advCrc16(const uint8_t* data, size_t len) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; ++i) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint8_t b = 0; b < 8; ++b) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static uint8_t* putU32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+    return p + 4;
+}
+
+static uint32_t getU32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+size_t advEncodeFrame(const AdvTable& table, const uint16_t* idx, uint16_t n,
+                      uint32_t windowMs, const AdvStats& windowStats,
+                      uint8_t* buf, size_t bufLen)
+{
+    if (n > 255) n = 255;
+
+    // hitung panjang dulu supaya tidak nulis setengah frame
+    size_t need = ADV_DUMP_HEADER_LEN + 2;
+    for (uint16_t k = 0; k < n; ++k) {
+        const AdvEntry& e = table.slot(idx[k]);
+        need += 6 + 1 + 4 + 3 + 1 + e.mfgLen + 1 + 1 + e.nameLen;
+        for (uint8_t u = 0; u < e.uuidCount; ++u) need += 1 + e.uuids[u].len;
+    }
+    if (need > bufLen) return 0;
+
+    uint8_t* p = buf;
+    memcpy(p, "ADVT", 4);
+    p += 4;
+    *p++ = ADV_DUMP_VERSION;
+    *p++ = (uint8_t)n;
+    p = putU32(p, windowMs);
+    p = putU32(p, windowStats.processed);
+    p = putU32(p, windowStats.parseErrors);
+    p = putU32(p, windowStats.tableFull);
+    p = putU32(p, windowStats.evicted);
+    p = putU32(p, windowStats.scanRestarts);
+
+    for (uint16_t k = 0; k < n; ++k) {
+        const AdvEntry& e = table.slot(idx[k]);
+        memcpy(p, e.addr, 6);
+        p += 6;
+        *p++ = e.addrType;
+        p = putU32(p, e.count);
+        *p++ = (uint8_t)e.rssiMin;
+        *p++ = (uint8_t)e.rssiMax;
+        *p++ = (uint8_t)e.rssiMean();
+        *p++ = e.mfgLen;
+        memcpy(p, e.mfg, e.mfgLen);
+        p += e.mfgLen;
+        *p++ = e.uuidCount;
+        for (uint8_t u = 0; u < e.uuidCount; ++u) {
+            *p++ = e.uuids[u].len;
+            memcpy(p, e.uuids[u].val, e.uuids[u].len);
+            p += e.uuids[u].len;
+        }
+        *p++ = e.nameLen;
+        memcpy(p, e.name, e.nameLen);
+        p += e.nameLen;
+    }
+
+    uint16_t crc = advCrc16(buf + 4, (size_t)(p - buf - 4));
+    *p++ = (uint8_t)crc;
+    *p++ = (uint8_t)(crc >> 8);
+    return (size_t)(p - buf);
+}
+
+bool advDecodeFrame(const uint8_t* buf, size_t len, AdvFrameHeader& hdr, size_t* frameLen,
+                    void (*onRecord)(const AdvEntry& e, void* ctx), void* ctx)
+{
+    if (len < ADV_DUMP_HEADER_LEN + 2 || memcmp(buf, "ADVT", 4) != 0) return false;
+
+    hdr.version   = buf[4];
+    hdr.count     = buf[5];
+    hdr.windowMs  = getU32(buf + 6);
+    hdr.processed    = getU32(buf + 10);
+    hdr.parseErrors  = getU32(buf + 14);
+    hdr.tableFull    = getU32(buf + 18);
+    hdr.evicted      = getU32(buf + 22);
+    hdr.scanRestarts = getU32(buf + 26);
+    if (hdr.version != ADV_DUMP_VERSION) return false;
+
+    // parse sekali untuk cari akhir frame, lalu cek CRC sebelum callback
+    const uint8_t* p   = buf + ADV_DUMP_HEADER_LEN;
+    const uint8_t* end = buf + len;
+    for (int pass = 0; pass < 2; ++pass) {
+        p = buf + ADV_DUMP_HEADER_LEN;
+        for (uint8_t k = 0; k < hdr.count; ++k) {
+            AdvEntry e = {};
+            if (end - p < 6 + 1 + 4 + 3 + 1) return false;
+            e.used = 1;
+            memcpy(e.addr, p, 6);
+            p += 6;
+            e.addrType = *p++;
+            e.count    = getU32(p);
+            p += 4;
+            e.rssiMin  = (int8_t)*p++;
+            e.rssiMax  = (int8_t)*p++;
+            e.rssiSum  = (int32_t)(int8_t)*p++ * (int32_t)e.count;
+            e.mfgLen   = *p++;
+            if (e.mfgLen > ADV_MFG_MAX || end - p < e.mfgLen + 1) return false;
+            memcpy(e.mfg, p, e.mfgLen);
+            p += e.mfgLen;
+            e.uuidCount = *p++;
+            if (e.uuidCount > ADV_UUID_MAX) return false;
+            for (uint8_t u = 0; u < e.uuidCount; ++u) {
+                if (end - p < 1) return false;
+                uint8_t ulen = *p++;
+                if (ulen > 16 || end - p < ulen) return false;
+                e.uuids[u].len = ulen;
+                memcpy(e.uuids[u].val, p, ulen);
+                p += ulen;
+            }
+            if (end - p < 1) return false;
+            e.nameLen = *p++;
+            if (e.nameLen > ADV_NAME_MAX || end - p < e.nameLen) return false;
+            memcpy(e.name, p, e.nameLen);
+            p += e.nameLen;
+
+            if (pass == 1 && onRecord) onRecord(e, ctx);
+        }
+
+        if (pass == 0) {
+            if (end - p < 2) return false;
+            uint16_t crc = (uint16_t)p[0] | ((uint16_t)p[1] << 8);
+            if (crc != advCrc16(buf + 4, (size_t)(p - buf - 4))) return false;
+            if (frameLen) *frameLen = (size_t)(p - buf) + 2;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,146 @@
+#pragma once
+// ======================================================================
+//  ADV TABLE (mode ScanForGetMac)
+//  Tabel device kapasitas tetap, open addressing (linear probing) by
+//  address. onResult cuma update tabel (tanpa String / Serial), ringkasan
+//  dicetak berkala dari loop() → UART tidak lagi jadi bottleneck saat
+//  ramai advert.
+//
+//  Statistik per window: beginWindow() dipanggil tiap ringkasan, nol-kan
+//  count/min/max per device dan buang device yang lama tidak terlihat.
+//  Kalau tabel penuh, device dengan lastSeenMs paling lama diganti
+//  (hapus pakai backward shift, jadi tidak perlu tombstone).
+//
+//  Advert yang hilang sebelum onResult (buffer HCI/controller penuh)
+//  tidak terlihat dari app: NimBLE-Arduino tidak membuka counter-nya.
+//  Yang dihitung cuma loss yang benar-benar terukur di sisi app.
+//
+//  Format dump biner juga didefinisikan di sini supaya encoder firmware
+//  dan decoder host (tools/adv_dump) selalu sama.
+// ======================================================================
+#include <stddef.h>
+#include <stdint.h>
+
+#define ADV_TABLE_CAPACITY 64   // harus pangkat 2
+#define ADV_MFG_MAX        24
+#define ADV_UUID_MAX       3
+#define ADV_NAME_MAX       20
+
+struct AdvUuid {
+    uint8_t len;        // 2, 4 atau 16 byte
+    uint8_t val[16];    // little-endian, sama seperti di payload
+};
+
+// Hasil parsing satu advertisement (pointer ke dalam payload asli).
+struct AdvSample {
+    uint8_t        addr[6];
+    uint8_t        addrType;
+    int8_t         rssi;
+    const uint8_t* mfg;
+    uint8_t        mfgLen;
+    const uint8_t* name;
+    uint8_t        nameLen;
+    uint8_t        uuidCount;
+    AdvUuid        uuids[ADV_UUID_MAX];
+};
+
+struct AdvEntry {
+    uint8_t  used;
+    uint8_t  addr[6];
+    uint8_t  addrType;
+    uint32_t count;
+    int32_t  rssiSum;
+    int8_t   rssiMin;
+    int8_t   rssiMax;
+    uint8_t  mfgLen;
+    uint8_t  mfg[ADV_MFG_MAX];
+    uint8_t  uuidCount;
+    AdvUuid  uuids[ADV_UUID_MAX];
+    uint8_t  nameLen;
+    char     name[ADV_NAME_MAX];
+    uint32_t lastSeenMs;
+
+    int8_t rssiMean() const;
+};
+
+// Parse AD structures (name, 0xFF manufacturer, 16/32/128-bit UUID list).
+// Return false kalau payload rusak (panjang AD melewati buffer).
+bool advParsePayload(const uint8_t* payload, size_t len, AdvSample& out);
+
+struct AdvStats {
+    uint32_t processed;     // advert yang masuk tabel
+    uint32_t parseErrors;   // payload rusak, advert dibuang
+    uint32_t tableFull;     // device baru tetap tidak dapat slot (advert dibuang)
+    uint32_t evicted;       // device lama diganti device baru; BUKAN advert hilang
+    uint32_t scanRestarts;  // scan berhenti sendiri (onScanEnd), advert di jeda hilang
+};
+
+class AdvTable {
+public:
+    void clear();
+
+    // Tabel penuh → device paling lama tidak terlihat diganti (evicted).
+    bool update(const AdvSample& s, uint32_t nowMs);
+
+    void noteParseError()  { stats_.parseErrors++; }
+    void noteScanRestart() { stats_.scanRestarts++; }
+
+    // Mulai window baru: stats + count/min/max per device di-nol-kan,
+    // device yang tidak terlihat >= expireMs dihapus.
+    void beginWindow(uint32_t nowMs, uint32_t expireMs);
+
+    uint16_t size() const { return used_; }
+    const AdvEntry& slot(uint16_t i) const { return entries_[i]; }
+    const AdvStats& stats() const { return stats_; }
+
+    // Isi idx[] dengan index slot yang terlihat di window ini, urut mean
+    // RSSI (terdekat dulu). Return jumlah index.
+    uint16_t sortedByRssi(uint16_t* idx, uint16_t maxIdx) const;
+
+private:
+    void removeAt(uint16_t pos);
+    void evictOldest();
+
+    AdvEntry entries_[ADV_TABLE_CAPACITY] = {};
+    uint16_t used_  = 0;
+    AdvStats stats_ = {};
+};
+
+// ======================================================================
+//  DUMP BINER
+//  Frame: "ADVT" | ver u8 | n u8 | windowMs u32 | processed u32 |
+//         parseErrors u32 | tableFull u32 | evicted u32 | scanRestarts u32 |
+//         n × record | crc16 (CCITT, semua byte setelah magic).
+//         Semua angka per window, bukan sejak boot.
+//  Record: addr[6] type u8 count u32 min i8 max i8 mean i8
+//          mfgLen u8 mfg[..] uuidCount u8 (len u8 val[len])* nameLen u8 name[..]
+//  Integer multi-byte little-endian.
+// ======================================================================
+#define ADV_DUMP_VERSION 3
+#define ADV_DUMP_HEADER_LEN (4 + 1 + 1 + 4 + 5 * 4)
+#define ADV_DUMP_RECORD_MAX (6 + 1 + 4 + 3 + 1 + ADV_MFG_MAX + 1 + ADV_UUID_MAX * 17 + 1 + ADV_NAME_MAX)
+#define ADV_DUMP_FRAME_MAX  (ADV_DUMP_HEADER_LEN + ADV_TABLE_CAPACITY * ADV_DUMP_RECORD_MAX + 2)
+
+uint16_t advCrc16(const uint8_t* data, size_t len);
+
+// Encode n entry (urutan idx[]) ke buf. Return panjang frame, 0 kalau buf kurang.
+size_t advEncodeFrame(const AdvTable& table, const uint16_t* idx, uint16_t n,
+                      uint32_t windowMs, const AdvStats& windowStats,
+                      uint8_t* buf, size_t bufLen);
+
+struct AdvFrameHeader {
+    uint8_t  version;
+    uint8_t  count;
+    uint32_t windowMs;
+    uint32_t processed;
+    uint32_t parseErrors;
+    uint32_t tableFull;
+    uint32_t evicted;
+    uint32_t scanRestarts;
+};
+
+// Decode satu frame mulai dari magic; buf boleh lebih panjang dari frame.
+// Callback dipanggil per record, *frameLen diisi panjang frame.
+// Return false kalau magic/versi/CRC tidak valid atau data belum lengkap.
+bool advDecodeFrame(const uint8_t* buf, size_t len, AdvFrameHeader& hdr, size_t* frameLen,
+                    void (*onRecord)(const AdvEntry& e, void* ctx), void* ctx);
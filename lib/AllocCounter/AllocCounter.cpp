@@ -0,0 +1,69 @@
+#include "AllocCounter.h"
+#include <stdlib.h>
+#include <new>
+
+#ifdef ESP_PLATFORM
+  #include <esp_attr.h>
+#else
+  #define IRAM_ATTR
+#endif
+
+static volatile uint32_t allocCount = 0;
+static volatile uint32_t allocBytes = 0;
+
+// IRAM: malloc bisa dipanggil waktu cache flash mati.
+// Increment biasa (bukan atomic) supaya tidak tergantung helper libatomic
+// di RISC-V tanpa ekstensi A; yang dicari "nol vs tidak nol", bukan angka pas.
+void IRAM_ATTR allocCounterNote(size_t size) {
+    allocCount = allocCount + 1;
+    allocBytes = allocBytes + (uint32_t)size;
+}
+
+uint32_t allocCounterCount() { return allocCount; }
+uint32_t allocCounterBytes() { return allocBytes; }
+
+#if defined(ESP_PLATFORM) && defined(ALLOC_COUNTER)
+// ======================================================================
+//  FIRMWARE: -Wl,--wrap=malloc -Wl,--wrap=calloc -Wl,--wrap=realloc
+// ======================================================================
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t n, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+void* IRAM_ATTR __wrap_malloc(size_t size) {
+    allocCounterNote(size);
+    return __real_malloc(size);
+}
+
+void* IRAM_ATTR __wrap_calloc(size_t n, size_t size) {
+    allocCounterNote(n * size);
+    return __real_calloc(n, size);
+}
+
+void* IRAM_ATTR __wrap_realloc(void* ptr, size_t size) {
+    allocCounterNote(size);
+    return __real_realloc(ptr, size);
+}
+}
+
+#elif !defined(ESP_PLATFORM)
+// ======================================================================
+//  HOST: ganti operator new/delete global
+// ======================================================================
+void* operator new(size_t size) {
+    allocCounterNote(size);
+    void* p = malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+#endif
@@ -0,0 +1,23 @@
+#pragma once
+// ======================================================================
+//  ALLOC COUNTER
+//  Hitung jumlah/byte alokasi heap untuk cek "tidak ada alokasi setelah
+//  setup()".
+//
+//  Firmware: aktif di env *-alloccheck (platformio.ini). Yang di-wrap
+//  cuma simbol malloc/calloc/realloc (-Wl,--wrap), jadi yang terhitung
+//  hanya pemanggil lewat simbol itu: kode sketch, operator new, String,
+//  dan library yang memanggil malloc langsung. TIDAK terhitung:
+//  heap_caps_malloc (dipakai IDF/FreeRTOS/driver), mbuf NimBLE (pool
+//  os_mbuf sendiri), _malloc_r newlib, dan alokasi internal IDF yang
+//  sudah ter-link di library prebuilt. Nol di sini berarti "kode kita
+//  tidak alokasi", bukan "heap sama sekali tidak tersentuh".
+//  Host: operator new/delete global diganti saat file ini ikut di-link,
+//  jadi program host bisa assert allocCounterCount() tidak berubah.
+// ======================================================================
+#include <stddef.h>
+#include <stdint.h>
+
+void     allocCounterNote(size_t size);
+uint32_t allocCounterCount();
+uint32_t allocCounterBytes();
@@ -0,0 +1,45 @@
+#include "BootTiming.h"
+#include <stddef.h>
+#include <string.h>
+
+static const uint32_t BOOT_CACHE_MAGIC = 0x4B455931;   // "KEY1"
+
+const char* bootPhaseName(BootPhase p) {
+    switch (p) {
+        case BOOT_SETUP_ENTER:    return "setup";
+        case BOOT_GPIO_SAFE:      return "gpio-safe";
+        case BOOT_BLE_INIT:       return "ble-init";
+        case BOOT_FAST_RECONNECT: return "fast-reconnect";
+        case BOOT_SCAN_START:     return "scan-start";
+        case BOOT_KEY_FOUND:      return "key-found";
+        case BOOT_CONNECTED:      return "connected";
+        case BOOT_UNLOCK:         return "unlock";
+        default:                  return "?";
+    }
+}
+
+// FNV-1a di semua field kecuali checksum itu sendiri
+static uint32_t bootCacheHash(const BootRtcCache& c) {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(&c);
+    const size_t   n = offsetof(BootRtcCache, checksum);
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < n; ++i) {
+        h ^= p[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+bool bootCacheValid(const BootRtcCache& c) {
+    return c.magic == BOOT_CACHE_MAGIC && c.checksum == bootCacheHash(c);
+}
+
+void bootCacheReset(BootRtcCache& c) {
+    memset(&c, 0, sizeof(c));
+    c.magic = BOOT_CACHE_MAGIC;
+    bootCacheSeal(c);
+}
+
+void bootCacheSeal(BootRtcCache& c) {
+    c.checksum = bootCacheHash(c);
+}
@@ -0,0 +1,58 @@
+#pragma once
+// ======================================================================
+//  BOOT TIMING
+//  Timestamp fase boot supaya app→scan dan app→unlock bisa diukur dan
+//  dibandingkan antar boot.
+//
+//  Satuan: µs dari esp_timer_get_time(). esp_timer mulai dari 0 saat IDF
+//  start app (sebelum app_main/setup), jadi angka ini TIDAK termasuk ROM
+//  bootloader + second-stage bootloader (load image dari flash, biasanya
+//  puluhan..ratusan ms tergantung ukuran image dan mode flash). Latensi
+//  reset→unlock yang dirasakan rider = waktu bootloader + angka di sini.
+//
+//  Ditambah cache key terakhir yang disimpan di RTC memory (RTC_NOINIT)
+//  supaya setelah ESP.restart()/brownout bisa langsung reconnect tanpa
+//  nunggu scan. Validasi pakai magic + checksum karena isi RTC_NOINIT
+//  acak setelah power-on.
+// ======================================================================
+#include <stdint.h>
+
+enum BootPhase : uint8_t {
+    BOOT_SETUP_ENTER = 0,
+    BOOT_GPIO_SAFE,
+    BOOT_BLE_INIT,
+    BOOT_FAST_RECONNECT,   // connect langsung ke key dari cache RTC
+    BOOT_SCAN_START,
+    BOOT_KEY_FOUND,        // advert key ketemu di scan
+    BOOT_CONNECTED,
+    BOOT_UNLOCK,           // CONTACT pertama kali ON
+    BOOT_PHASE_COUNT
+};
+
+const char* bootPhaseName(BootPhase p);
+
+struct BootTiming {
+    uint32_t appUs[BOOT_PHASE_COUNT];   // µs sejak app start; 0 = belum tercapai
+
+    // Hanya kejadian pertama yang dicatat.
+    void mark(BootPhase p, uint32_t nowUs) {
+        if (p < BOOT_PHASE_COUNT && appUs[p] == 0) appUs[p] = nowUs ? nowUs : 1;
+    }
+    bool has(BootPhase p) const { return p < BOOT_PHASE_COUNT && appUs[p] != 0; }
+};
+
+// Hasil boot sebelumnya + key terakhir, hidup di RTC_NOINIT.
+struct BootRtcCache {
+    uint32_t magic;
+    uint8_t  keyAddr[6];
+    uint8_t  keyAddrType;
+    uint8_t  keyValid;
+    uint32_t lastAppToScanUs;      // sama seperti BootTiming: tanpa bootloader
+    uint32_t lastAppToUnlockUs;    // 0 = boot sebelumnya tidak sampai unlock
+    uint32_t bootCount;
+    uint32_t checksum;
+};
+
+bool bootCacheValid(const BootRtcCache& c);
+void bootCacheReset(BootRtcCache& c);
+void bootCacheSeal(BootRtcCache& c);   // hitung ulang checksum setelah ubah field
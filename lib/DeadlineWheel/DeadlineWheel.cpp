@@ -0,0 +1,180 @@
+#include "DeadlineWheel.h"
+
+// ======================================================================
+//  WHEEL
+// ======================================================================
+void DeadlineWheel::lock() {
+#ifdef ESP_PLATFORM
+    portENTER_CRITICAL(&mux_);
+#endif
+}
+
+void DeadlineWheel::unlock() {
+#ifdef ESP_PLATFORM
+    portEXIT_CRITICAL(&mux_);
+#endif
+}
+
+void DeadlineWheel::begin(DeadlineClock* clock) {
+    lock();
+    clock_   = clock;
+    events_  = 0;
+    armedAt_ = 0;
+    for (uint8_t i = 0; i < DEADLINE_MAX_TIMERS; ++i) {
+        slots_[i].armed = false;
+    }
+    unlock();
+}
+
+void DeadlineWheel::setCallback(uint8_t id, DeadlineCallback cb, void* arg) {
+    if (id >= DEADLINE_MAX_TIMERS) return;
+    lock();
+    slots_[id].cb  = cb;
+    slots_[id].arg = arg;
+    unlock();
+}
+
+void DeadlineWheel::scheduleAt(uint8_t id, uint64_t atUs) {
+    if (id >= DEADLINE_MAX_TIMERS || !clock_) return;
+    if (atUs == 0) atUs = 1;   // 0 dipakai sebagai "tidak di-arm"
+
+    lock();
+    slots_[id].atUs  = atUs;
+    slots_[id].armed = true;
+    slots_[id].gen++;
+    events_ &= ~deadlineBit(id);
+    rearmLocked();
+    unlock();
+}
+
+void DeadlineWheel::scheduleIn(uint8_t id, uint64_t delayUs) {
+    if (!clock_) return;
+    scheduleAt(id, clock_->nowUs() + delayUs);
+}
+
+void DeadlineWheel::cancel(uint8_t id) {
+    if (id >= DEADLINE_MAX_TIMERS) return;
+    lock();
+    slots_[id].armed = false;
+    slots_[id].gen++;
+    events_ &= ~deadlineBit(id);
+    rearmLocked();
+    unlock();
+}
+
+bool DeadlineWheel::pending(uint8_t id) const {
+    return id < DEADLINE_MAX_TIMERS && slots_[id].armed;
+}
+
+uint32_t DeadlineWheel::takeEvents() {
+    lock();
+    uint32_t ev = events_;
+    events_ = 0;
+    unlock();
+    return ev;
+}
+
+void DeadlineWheel::onTimer() {
+    // Salinan callback yang expired; dipanggil setelah unlock.
+    struct Due {
+        uint8_t          id;
+        uint32_t         gen;
+        DeadlineCallback cb;
+        void*            arg;
+    };
+    Due     due[DEADLINE_MAX_TIMERS];
+    uint8_t dueCount = 0;
+
+    lock();
+    armedAt_ = 0;   // one-shot sudah habis
+
+    uint64_t now = clock_->nowUs();
+    for (uint8_t i = 0; i < DEADLINE_MAX_TIMERS; ++i) {
+        Slot& s = slots_[i];
+        if (!s.armed || s.atUs > now) continue;
+
+        s.armed = false;
+        uint64_t late = now - s.atUs;
+        s.lastLateUs = late > 0xFFFFFFFFULL ? 0xFFFFFFFFUL : (uint32_t)late;
+        if (s.lastLateUs > s.maxLateUs) s.maxLateUs = s.lastLateUs;
+
+        events_ |= deadlineBit(i);
+        if (s.cb) due[dueCount++] = Due{ i, s.gen, s.cb, s.arg };
+    }
+
+    rearmLocked();
+    unlock();
+
+    for (uint8_t k = 0; k < dueCount; ++k) {
+        // Slot di-schedule ulang / cancel sejak expired (mis. oleh callback
+        // sebelumnya) → deadline lama batal, yang baru fire di waktunya.
+        lock();
+        bool current = slots_[due[k].id].gen == due[k].gen;
+        unlock();
+        if (current) due[k].cb(due[k].id, due[k].arg);
+    }
+}
+
+// Arm hardware ke deadline terdekat; skip kalau sudah ke titik yang sama.
+void DeadlineWheel::rearmLocked() {
+    uint64_t next = 0;
+    for (uint8_t i = 0; i < DEADLINE_MAX_TIMERS; ++i) {
+        if (slots_[i].armed && (next == 0 || slots_[i].atUs < next)) {
+            next = slots_[i].atUs;
+        }
+    }
+
+    if (next == armedAt_) return;
+
+    armedAt_ = next;
+    if (next == 0) {
+        clock_->disarm();
+    } else {
+        clock_->arm(next);
+    }
+}
+
+// ======================================================================
+//  BACKEND esp_timer
+// ======================================================================
+#ifdef ESP_PLATFORM
+bool EspDeadlineClock::begin(DeadlineWheel* wheel) {
+    esp_timer_create_args_t args = {};
+    args.callback        = &EspDeadlineClock::fire;
+    args.arg             = wheel;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name            = "deadline";
+    return esp_timer_create(&args, &timer_) == ESP_OK;
+}
+
+void EspDeadlineClock::fire(void* arg) {
+    static_cast<DeadlineWheel*>(arg)->onTimer();
+}
+
+void EspDeadlineClock::arm(uint64_t atUs) {
+    if (!timer_) return;
+    uint64_t now   = nowUs();
+    uint64_t delay = atUs > now ? atUs - now : 1;
+    esp_timer_stop(timer_);   // start_once gagal kalau timer masih jalan
+    esp_timer_start_once(timer_, delay);
+}
+
+void EspDeadlineClock::disarm() {
+    if (timer_) esp_timer_stop(timer_);
+}
+#endif
+
+// ======================================================================
+//  BACKEND VIRTUAL (host)
+// ======================================================================
+void VirtualDeadlineClock::advance(uint64_t us) {
+    const uint64_t target = now_ + us;
+
+    while (armed_ && at_ <= target) {
+        armed_ = false;
+        uint64_t fireAt = at_ + latencyUs_;
+        now_ = fireAt > now_ ? fireAt : now_;
+        if (wheel_) wheel_->onTimer();
+    }
+    if (target > now_) now_ = target;
+}
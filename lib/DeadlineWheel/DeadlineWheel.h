@@ -0,0 +1,136 @@
+#pragma once
+// ======================================================================
+//  DEADLINE WHEEL
+//  Semua timeout protokol didaftarkan sebagai deadline absolut (µs).
+//  Cuma satu hardware one-shot yang di-arm, selalu ke deadline terdekat,
+//  jadi presisi tidak tergantung lama satu iterasi loop().
+//
+//  Tiap slot bisa punya:
+//   - callback  → jalan langsung di konteks timer (task esp_timer),
+//                 untuk aksi yang harus tepat waktu (mis. relay OFF).
+//                 Harus singkat dan tidak boleh blocking. Dipanggil di
+//                 luar lock (boleh schedule/cancel dari callback); slot
+//                 yang di-schedule ulang / cancel setelah expired tapi
+//                 sebelum callback-nya jalan tidak di-fire (generation).
+//                 Deadline yang sama di-fire urut id kecil dulu.
+//   - event bit → diambil loop() lewat takeEvents() untuk logika biasa.
+//
+//  Jumlah timer kecil dan tetap, jadi slot dicari linear; lebih murah
+//  daripada hashed wheel untuk < 32 entry.
+//
+//  Backend clock:
+//   - EspDeadlineClock     : esp_timer one-shot (firmware)
+//   - VirtualDeadlineClock : clock virtual untuk host / simulasi
+// ======================================================================
+#include <stdint.h>
+
+#ifdef ESP_PLATFORM
+  #include <freertos/FreeRTOS.h>
+  #include <esp_timer.h>
+#endif
+
+#define DEADLINE_MAX_TIMERS 16
+
+inline uint32_t deadlineBit(uint8_t id) { return 1UL << id; }
+
+typedef void (*DeadlineCallback)(uint8_t id, void* arg);
+
+class DeadlineWheel;
+
+class DeadlineClock {
+public:
+    virtual ~DeadlineClock() {}
+    virtual uint64_t nowUs() = 0;
+    virtual void     arm(uint64_t atUs) = 0;   // ganti one-shot yang sedang jalan
+    virtual void     disarm() = 0;
+};
+
+class DeadlineWheel {
+public:
+    void begin(DeadlineClock* clock);
+
+    // Opsional: aksi di konteks timer saat slot expired (event bit tetap diset).
+    void setCallback(uint8_t id, DeadlineCallback cb, void* arg = nullptr);
+
+    // Jadwal ulang membatalkan deadline lama + event yang belum diambil.
+    void scheduleAt(uint8_t id, uint64_t atUs);
+    void scheduleIn(uint8_t id, uint64_t delayUs);
+    void cancel(uint8_t id);
+    bool pending(uint8_t id) const;
+
+    uint64_t nowUs() const { return clock_ ? clock_->nowUs() : 0; }
+
+    // Ambil sekaligus hapus semua event bit yang sudah expired.
+    uint32_t takeEvents();
+
+    // Keterlambatan dispatch terakhir / maksimum per slot (µs).
+    uint32_t lastLateUs(uint8_t id) const { return id < DEADLINE_MAX_TIMERS ? slots_[id].lastLateUs : 0; }
+    uint32_t maxLateUs(uint8_t id) const  { return id < DEADLINE_MAX_TIMERS ? slots_[id].maxLateUs : 0; }
+
+    // Dipanggil backend waktu one-shot fire.
+    void onTimer();
+
+private:
+    struct Slot {
+        uint64_t         atUs;
+        DeadlineCallback cb;
+        void*            arg;
+        uint32_t         lastLateUs;
+        uint32_t         maxLateUs;
+        uint32_t         gen;   // naik tiap schedule/cancel
+        bool             armed;
+    };
+
+    void lock();
+    void unlock();
+    void rearmLocked();
+
+    DeadlineClock*    clock_   = nullptr;
+    Slot              slots_[DEADLINE_MAX_TIMERS] = {};
+    volatile uint32_t events_  = 0;
+    uint64_t          armedAt_ = 0;     // 0 = hardware timer tidak di-arm
+#ifdef ESP_PLATFORM
+    portMUX_TYPE      mux_     = portMUX_INITIALIZER_UNLOCKED;
+#endif
+};
+
+#ifdef ESP_PLATFORM
+class EspDeadlineClock : public DeadlineClock {
+public:
+    // Buat esp_timer one-shot yang memanggil wheel.onTimer().
+    bool begin(DeadlineWheel* wheel);
+
+    uint64_t nowUs() override { return (uint64_t)esp_timer_get_time(); }
+    void     arm(uint64_t atUs) override;
+    void     disarm() override;
+
+private:
+    static void fire(void* arg);
+
+    esp_timer_handle_t timer_ = nullptr;
+};
+#endif
+
+// Clock virtual: waktu cuma maju lewat advance(), deadline yang lewat
+// di-fire berurutan. dispatchLatencyUs mensimulasikan telat dispatch.
+class VirtualDeadlineClock : public DeadlineClock {
+public:
+    void attach(DeadlineWheel* wheel) { wheel_ = wheel; }
+
+    uint64_t nowUs() override { return now_; }
+    void     arm(uint64_t atUs) override { armed_ = true; at_ = atUs; }
+    void     disarm() override { armed_ = false; }
+
+    void advance(uint64_t us);
+    void setDispatchLatency(uint32_t us) { latencyUs_ = us; }
+
+    bool     armed() const { return armed_; }
+    uint64_t armedAt() const { return at_; }
+
+private:
+    DeadlineWheel* wheel_     = nullptr;
+    uint64_t       now_       = 0;
+    uint64_t       at_        = 0;
+    bool           armed_     = false;
+    uint32_t       latencyUs_ = 0;
+};
@@ -0,0 +1,169 @@
+#include "EnergyProfiler.h"
+
+// ======================================================================
+//  TABEL ARUS PER BOARD
+//  Angka awal dari datasheet + pengukuran kasar; ganti dengan hasil
+//  ukur di motor masing-masing kalau ada.
+// ======================================================================
+const BoardCurrentTable ENERGY_BOARD_ESP32C3_SUPERMINI = {
+    "esp32c3-supermini",
+    3.3f,    // logicVolt
+    12.0f,   // batteryVolt
+    0.85f,   // regulatorEff (buck)
+    20.0f,   // cpuIdleMa   (160 MHz, modem sleep)
+    64.0f,   // radioRxMa   (RX ~84 mA total)
+    3.0f,    // activeScanExtraMa
+    26.0f,   // connectedMa
+    70.0f,   // advTxMa     (TX 0 dBm ~90 mA total)
+    { 150.0f, 150.0f, 150.0f }   // CONTACT, SEIN, HORN (relay otomotif 12 V)
+};
+
+const BoardCurrentTable ENERGY_BOARD_ESP32_DEVKIT = {
+    "esp32-devkit-v1",
+    3.3f,
+    12.0f,
+    0.60f,   // LDO AMS1117 di devkit
+    32.0f,
+    68.0f,
+    4.0f,
+    40.0f,
+    80.0f,
+    { 150.0f, 150.0f, 150.0f }
+};
+
+static const float MS_PER_DAY = 24.0f * 3600.0f * 1000.0f;
+static const float MS_PER_HOUR = 3600.0f * 1000.0f;
+
+float energyScanDuty(uint16_t intervalMs, uint16_t windowMs) {
+    if (intervalMs == 0 || windowMs >= intervalMs) return 1.0f;
+    return (float)windowMs / (float)intervalMs;
+}
+
+float energyAdvDuty(uint16_t intervalMs) {
+    if (intervalMs == 0 || ENERGY_ADV_EVENT_MS >= intervalMs) return 1.0f;
+    return ENERGY_ADV_EVENT_MS / (float)intervalMs;
+}
+
+const char* energyStateName(EnergyRadioState s) {
+    switch (s) {
+        case ENERGY_SCAN_ACTIVE:  return "SCAN_ACTIVE";
+        case ENERGY_SCAN_PASSIVE: return "SCAN_PASSIVE";
+        case ENERGY_CONNECTED:    return "CONNECTED";
+        case ENERGY_IDLE:         return "IDLE";
+        default:                  return "?";
+    }
+}
+
+void energySplitMahPerDay(const EnergyTotals& t, const BoardCurrentTable& board,
+                          float* logicMah, float* relayMah)
+{
+    float lm = 0.0f;
+    float rm = 0.0f;
+
+    if (t.totalMs > 0) {
+        const float scale = MS_PER_DAY / (float)t.totalMs;
+
+        // muatan sisi 3V3 dalam mA·ms
+        float logicMaMs =
+            board.cpuIdleMa * (float)(t.stateMs[ENERGY_SCAN_ACTIVE] +
+                                      t.stateMs[ENERGY_SCAN_PASSIVE] +
+                                      t.stateMs[ENERGY_IDLE]) +
+            board.radioRxMa         * (float)t.scanRxMs +
+            board.activeScanExtraMa * (float)t.stateMs[ENERGY_SCAN_ACTIVE] +
+            board.connectedMa       * (float)t.stateMs[ENERGY_CONNECTED] +
+            board.advTxMa           * (float)t.advTxMs;
+
+        // konversi ke sisi aki: P_logic / (V_aki × eff)
+        float toBattery = board.logicVolt / (board.batteryVolt * board.regulatorEff);
+        lm = logicMaMs * toBattery / MS_PER_HOUR * scale;
+
+        float relayMaMs = 0.0f;
+        for (uint8_t r = 0; r < ENERGY_RELAY_COUNT; ++r) {
+            relayMaMs += board.relayCoilMa[r] * (float)t.relayMs[r];
+        }
+        rm = relayMaMs / MS_PER_HOUR * scale;
+    }
+
+    if (logicMah) *logicMah = lm;
+    if (relayMah) *relayMah = rm;
+}
+
+float energyEstimateMahPerDay(const EnergyTotals& t, const BoardCurrentTable& board) {
+    float lm, rm;
+    energySplitMahPerDay(t, board, &lm, &rm);
+    return lm + rm;
+}
+
+// ======================================================================
+//  PROFILER RUNTIME
+// ======================================================================
+void EnergyProfiler::begin(uint32_t nowMs, EnergyRadioState s, float scanDuty) {
+    totals_   = EnergyTotals{};
+    state_    = s;
+    scanDuty_ = scanDuty;
+    lastMs_   = nowMs;
+    rxCarryMs_ = 0.0f;
+    advDuty_    = 0.0f;
+    advCarryMs_ = 0.0f;
+    for (uint8_t r = 0; r < ENERGY_RELAY_COUNT; ++r) {
+        relayWeight_[r]  = 0.0f;
+        relayLastMs_[r]  = nowMs;
+        relayCarryMs_[r] = 0.0f;
+    }
+}
+
+void EnergyProfiler::flush(uint32_t nowMs) {
+    uint32_t dt = nowMs - lastMs_;   // aman terhadap wrap millis()
+    lastMs_ = nowMs;
+
+    totals_.stateMs[state_] += dt;
+    totals_.totalMs         += dt;
+
+    if (state_ == ENERGY_SCAN_ACTIVE || state_ == ENERGY_SCAN_PASSIVE) {
+        rxCarryMs_ += (float)dt * scanDuty_;
+        uint32_t whole = (uint32_t)rxCarryMs_;
+        totals_.scanRxMs += whole;
+        rxCarryMs_       -= (float)whole;
+    }
+
+    if (advDuty_ > 0.0f) {
+        totals_.advMs += dt;
+        advCarryMs_   += (float)dt * advDuty_;
+        uint32_t whole = (uint32_t)advCarryMs_;
+        totals_.advTxMs += whole;
+        advCarryMs_     -= (float)whole;
+    }
+
+    for (uint8_t r = 0; r < ENERGY_RELAY_COUNT; ++r) {
+        uint32_t rdt = nowMs - relayLastMs_[r];
+        relayLastMs_[r] = nowMs;
+        if (relayWeight_[r] <= 0.0f) continue;
+
+        relayCarryMs_[r] += (float)rdt * relayWeight_[r];
+        uint32_t whole = (uint32_t)relayCarryMs_[r];
+        totals_.relayMs[r] += whole;
+        relayCarryMs_[r]   -= (float)whole;
+    }
+}
+
+void EnergyProfiler::setRadioState(uint32_t nowMs, EnergyRadioState s, float scanDuty) {
+    flush(nowMs);
+    state_    = s;
+    scanDuty_ = scanDuty;
+}
+
+void EnergyProfiler::setAdvertising(uint32_t nowMs, bool on, float advDuty) {
+    flush(nowMs);
+    advDuty_ = on ? advDuty : 0.0f;
+}
+
+void EnergyProfiler::setRelay(uint32_t nowMs, EnergyRelay r, bool on, float weight) {
+    if (r >= ENERGY_RELAY_COUNT) return;
+    flush(nowMs);
+    relayWeight_[r] = on ? weight : 0.0f;
+}
+
+void EnergyProfiler::snapshot(uint32_t nowMs, EnergyTotals& out) {
+    flush(nowMs);
+    out = totals_;
+}
@@ -0,0 +1,106 @@
+#pragma once
+// ======================================================================
+//  ENERGY PROFILER
+//  Catat berapa lama radio/CPU ada di tiap state + berapa lama relay
+//  energized, lalu kalikan dengan tabel arus per board → estimasi mAh/hari.
+//  Advertising (server telemetry) dicatat terpisah karena jalan bersamaan
+//  dengan scan/connected, bukan state radio sendiri.
+//
+//  Sengaja tanpa Arduino.h supaya file yang sama bisa dipakai model host
+//  (tools/energy_model) untuk bandingkan policy scan sebelum flash.
+// ======================================================================
+#include <stdint.h>
+
+enum EnergyRadioState : uint8_t {
+    ENERGY_SCAN_ACTIVE = 0,
+    ENERGY_SCAN_PASSIVE,
+    ENERGY_CONNECTED,
+    ENERGY_IDLE,
+    ENERGY_RADIO_STATE_COUNT
+};
+
+enum EnergyRelay : uint8_t {
+    ENERGY_RELAY_CONTACT = 0,
+    ENERGY_RELAY_SEIN,
+    ENERGY_RELAY_HORN,
+    ENERGY_RELAY_COUNT
+};
+
+// Arus rata-rata per state. Sisi logic diukur di rail 3V3, relay di rail
+// aki (12 V). Semua dikonversi ke mAh di sisi aki waktu estimasi.
+struct BoardCurrentTable {
+    const char* name;
+    float logicVolt;           // rail MCU (V)
+    float batteryVolt;         // aki motor (V)
+    float regulatorEff;        // efisiensi buck 12V → 3V3 (0..1)
+    float cpuIdleMa;           // CPU jalan, radio idle (modem sleep)
+    float radioRxMa;           // tambahan arus saat RX window scan
+    float activeScanExtraMa;   // tambahan rata-rata TX scan request (active scan)
+    float connectedMa;         // rata-rata total saat connected (conn interval)
+    float advTxMa;             // tambahan arus selama advertising event (TX 3 channel)
+    float relayCoilMa[ENERGY_RELAY_COUNT];  // arus coil di 12 V, full drive
+};
+
+extern const BoardCurrentTable ENERGY_BOARD_ESP32C3_SUPERMINI;
+extern const BoardCurrentTable ENERGY_BOARD_ESP32_DEVKIT;
+
+struct EnergyTotals {
+    uint64_t stateMs[ENERGY_RADIO_STATE_COUNT];
+    uint64_t scanRxMs;                      // waktu RX efektif (durasi × window/interval)
+    uint64_t advMs;                         // lama advertising aktif
+    uint64_t advTxMs;                       // waktu TX efektif advertising (advMs × duty)
+    uint64_t relayMs[ENERGY_RELAY_COUNT];   // waktu ekuivalen full drive
+    uint64_t totalMs;
+};
+
+// Estimasi konsumsi dari totals, dinormalisasi ke 24 jam.
+float energyEstimateMahPerDay(const EnergyTotals& t, const BoardCurrentTable& board);
+
+// Kontribusi tiap bagian (mAh/hari) untuk laporan: radio total, relay total.
+void energySplitMahPerDay(const EnergyTotals& t, const BoardCurrentTable& board,
+                          float* logicMah, float* relayMah);
+
+// Duty RX scan dari parameter NimBLE (ms). window > interval dianggap 1.0.
+float energyScanDuty(uint16_t intervalMs, uint16_t windowMs);
+
+// Lama satu advertising event (3 channel, ADV_IND + jeda) dan duty-nya
+// untuk interval advertising (ms).
+#define ENERGY_ADV_EVENT_MS 1.5f
+float energyAdvDuty(uint16_t intervalMs);
+
+const char* energyStateName(EnergyRadioState s);
+
+class EnergyProfiler {
+public:
+    void begin(uint32_t nowMs, EnergyRadioState s, float scanDuty = 0.0f);
+
+    // Pindah state radio; waktu sejak transisi terakhir dibukukan ke state lama.
+    void setRadioState(uint32_t nowMs, EnergyRadioState s, float scanDuty = 0.0f);
+
+    // Advertising on/off, paralel dengan state radio. advDuty dari energyAdvDuty().
+    void setAdvertising(uint32_t nowMs, bool on, float advDuty = 0.0f);
+
+    // weight = fraksi daya coil terhadap full drive (1.0 = digitalWrite HIGH).
+    void setRelay(uint32_t nowMs, EnergyRelay r, bool on, float weight = 1.0f);
+
+    // Flush waktu berjalan lalu salin totals.
+    void snapshot(uint32_t nowMs, EnergyTotals& out);
+
+    EnergyRadioState radioState() const { return state_; }
+    bool             advertising() const { return advDuty_ > 0.0f; }
+
+private:
+    void flush(uint32_t nowMs);
+
+    EnergyTotals     totals_      = {};
+    EnergyRadioState state_       = ENERGY_IDLE;
+    float            scanDuty_    = 0.0f;
+    uint32_t         lastMs_      = 0;
+    float            relayWeight_[ENERGY_RELAY_COUNT] = {};
+    uint32_t         relayLastMs_[ENERGY_RELAY_COUNT] = {};
+    // sisa pecahan ms RX supaya duty kecil tidak hilang karena pembulatan
+    float            rxCarryMs_   = 0.0f;
+    float            advDuty_     = 0.0f;   // 0 = tidak advertising
+    float            advCarryMs_  = 0.0f;
+    float            relayCarryMs_[ENERGY_RELAY_COUNT] = {};
+};
@@ -0,0 +1,46 @@
+#include "NotifyRoutes.h"
+
+bool NotifyRouteTable::add(uint16_t connHandle, uint16_t attrHandle, uint8_t session,
+                           NotifyKind kind)
+{
+    NotifyRoute* slot = nullptr;
+    for (uint8_t i = 0; i < NOTIFY_ROUTE_CAPACITY; ++i) {
+        NotifyRoute& r = routes_[i];
+        if (r.used && r.connHandle == connHandle && r.attrHandle == attrHandle) {
+            slot = &r;
+            break;
+        }
+        if (!r.used && !slot) slot = &r;
+    }
+    if (!slot) return false;
+
+    slot->used       = false;   // callback tidak baca route setengah jadi
+    slot->connHandle = connHandle;
+    slot->attrHandle = attrHandle;
+    slot->session    = session;
+    slot->kind       = kind;
+    slot->used       = true;
+    return true;
+}
+
+const NotifyRoute* NotifyRouteTable::find(uint16_t connHandle, uint16_t attrHandle) const {
+    for (uint8_t i = 0; i < NOTIFY_ROUTE_CAPACITY; ++i) {
+        const NotifyRoute& r = routes_[i];
+        if (r.used && r.attrHandle == attrHandle && r.connHandle == connHandle) return &r;
+    }
+    return nullptr;
+}
+
+void NotifyRouteTable::removeSession(uint8_t session) {
+    for (uint8_t i = 0; i < NOTIFY_ROUTE_CAPACITY; ++i) {
+        if (routes_[i].session == session) routes_[i].used = false;
+    }
+}
+
+uint8_t NotifyRouteTable::count() const {
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < NOTIFY_ROUTE_CAPACITY; ++i) {
+        if (routes_[i].used) ++n;
+    }
+    return n;
+}
@@ -0,0 +1,35 @@
+#pragma once
+// ======================================================================
+//  NOTIFY ROUTES
+//  (conn handle, attr handle) → sesi + jenis characteristic. Diisi setelah
+//  subscribe berhasil, jadi notifyCallback tidak perlu banding UUID.
+//  Kapasitas tetap, tanpa alokasi; dipakai juga tools/alloc_check.
+// ======================================================================
+#include <stdint.h>
+
+#define NOTIFY_ROUTE_CAPACITY 8
+
+enum NotifyKind : uint8_t {
+    NOTIFY_BUTTON,
+    NOTIFY_BATTERY
+};
+
+struct NotifyRoute {
+    volatile bool used;
+    uint16_t      connHandle;
+    uint16_t      attrHandle;
+    uint8_t       session;
+    NotifyKind    kind;
+};
+
+class NotifyRouteTable {
+public:
+    // Handle yang sama ditimpa (discovery diulang); false = tabel penuh.
+    bool add(uint16_t connHandle, uint16_t attrHandle, uint8_t session, NotifyKind kind);
+    const NotifyRoute* find(uint16_t connHandle, uint16_t attrHandle) const;
+    void removeSession(uint8_t session);
+    uint8_t count() const;
+
+private:
+    NotifyRoute routes_[NOTIFY_ROUTE_CAPACITY] = {};
+};
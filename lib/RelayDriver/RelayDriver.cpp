@@ -0,0 +1,180 @@
+#include "RelayDriver.h"
+
+#ifdef ESP_PLATFORM
+  #include <Arduino.h>
+#endif
+
+// ======================================================================
+//  DRIVER
+// ======================================================================
+void RelayDriver::lock() {
+#ifdef ESP_PLATFORM
+    portENTER_CRITICAL(&mux_);
+#endif
+}
+
+void RelayDriver::unlock() {
+#ifdef ESP_PLATFORM
+    portEXIT_CRITICAL(&mux_);
+#endif
+}
+
+void RelayDriver::begin(RelayOutput* out, DeadlineWheel* wheel, uint8_t firstTimerId, uint8_t count) {
+    out_     = out;
+    wheel_   = wheel;
+    firstId_ = firstTimerId;
+    count_   = count > RELAY_DRIVER_MAX ? RELAY_DRIVER_MAX : count;
+
+    uint64_t now = wheel_->nowUs();
+    for (uint8_t r = 0; r < count_; ++r) {
+        profile_[r] = RelayProfile{ 0, 1.0f };
+        state_[r]   = STATE_OFF;
+        lastUs_[r]  = now;
+        stats_[r]   = RelayStats{};
+        out_->write(r, 0);
+        wheel_->setCallback(firstId_ + r, &RelayDriver::onHoldDeadline, this);
+    }
+}
+
+void RelayDriver::setProfile(uint8_t relay, const RelayProfile& p) {
+    if (relay >= count_) return;
+    lock();
+    profile_[relay] = p;
+    unlock();
+}
+
+float RelayDriver::dutyOf(uint8_t relay, State s) const {
+    if (s == STATE_OFF)     return 0.0f;
+    if (s == STATE_PULL_IN) return 1.0f;
+    float d = profile_[relay].holdDuty;
+    return d > 1.0f ? 1.0f : (d < 0.0f ? 0.0f : d);
+}
+
+void RelayDriver::accountLocked(uint8_t relay, uint64_t nowUs) {
+    uint64_t dt = nowUs - lastUs_[relay];
+    lastUs_[relay] = nowUs;
+    if (state_[relay] == STATE_OFF) return;
+
+    stats_[relay].onUs    += dt;
+    stats_[relay].driveUs += (uint64_t)((double)dt * relayCoilWeight(dutyOf(relay, state_[relay])));
+}
+
+void RelayDriver::driveLocked(uint8_t relay, State s, uint64_t nowUs) {
+    accountLocked(relay, nowUs);
+    state_[relay] = s;
+
+    float duty = dutyOf(relay, s);
+    out_->write(relay, (uint16_t)(duty * RELAY_PWM_MAX + 0.5f));
+    if (hook_) hook_(relay, relayCoilWeight(duty), hookArg_);
+}
+
+void RelayDriver::on(uint8_t relay) {
+    if (relay >= count_) return;
+
+    uint64_t now = wheel_->nowUs();
+    bool     needHold;
+    uint64_t holdAt;
+
+    lock();
+    if (state_[relay] != STATE_OFF) {   // sudah ON, jangan pull-in ulang
+        unlock();
+        return;
+    }
+    const RelayProfile& p = profile_[relay];
+    needHold = p.holdDuty < 1.0f && p.pullInMs > 0;
+    holdAt   = now + (uint64_t)p.pullInMs * 1000ULL;
+
+    stats_[relay].activations++;
+    holdAtUs_[relay] = holdAt;
+    driveLocked(relay, needHold ? STATE_PULL_IN : STATE_HOLD, now);
+    unlock();
+
+    // Di luar lock driver: scheduleAt() ambil lock wheel sendiri, jadi dua
+    // spinlock tidak pernah bersarang dan critical section tetap pendek.
+    if (needHold) wheel_->scheduleAt(firstId_ + relay, holdAt);
+}
+
+void RelayDriver::off(uint8_t relay) {
+    if (relay >= count_) return;
+
+    uint64_t now = wheel_->nowUs();
+    lock();
+    if (state_[relay] != STATE_OFF) driveLocked(relay, STATE_OFF, now);
+    unlock();
+    // Deadline hold yang masih pending dibiarkan: state OFF → diabaikan.
+}
+
+// Konteks timer (task esp_timer), dipanggil wheel di luar lock wheel.
+void RelayDriver::onHoldDeadline(uint8_t id, void* arg) {
+    RelayDriver* d = static_cast<RelayDriver*>(arg);
+    uint8_t relay  = id - d->firstId_;
+    if (relay >= d->count_) return;
+
+    uint64_t now = d->wheel_->nowUs();
+    d->lock();
+    // holdAtUs_ dicek supaya deadline dari aktivasi sebelumnya tidak
+    // memotong pull-in aktivasi baru.
+    if (d->state_[relay] == STATE_PULL_IN && now >= d->holdAtUs_[relay]) {
+        d->driveLocked(relay, STATE_HOLD, now);
+    }
+    d->unlock();
+}
+
+void RelayDriver::stats(uint8_t relay, RelayStats& out) {
+    if (relay >= count_) {
+        out = RelayStats{};
+        return;
+    }
+    uint64_t now = wheel_->nowUs();
+    lock();
+    accountLocked(relay, now);
+    out = stats_[relay];
+    unlock();
+}
+
+void RelayDriver::resetStats() {
+    uint64_t now = wheel_->nowUs();
+    lock();
+    for (uint8_t r = 0; r < count_; ++r) {
+        accountLocked(r, now);
+        stats_[r] = RelayStats{};
+    }
+    unlock();
+}
+
+// ======================================================================
+//  BACKEND LEDC
+// ======================================================================
+#ifdef ESP_PLATFORM
+void LedcRelayOutput::begin(const uint8_t* pins, uint8_t count) {
+    count_ = count > RELAY_DRIVER_MAX ? RELAY_DRIVER_MAX : count;
+
+    for (uint8_t i = 0; i < count_; ++i) {
+        pins_[i] = pins[i];
+#if defined(ESP_ARDUINO_VERSION_MAJOR) && ESP_ARDUINO_VERSION_MAJOR >= 3
+        pwm_[i] = ledcAttachChannel(pins[i], RELAY_PWM_FREQ_HZ, RELAY_PWM_BITS, i);
+#else
+        pwm_[i] = ledcSetup(i, RELAY_PWM_FREQ_HZ, RELAY_PWM_BITS) != 0;
+        if (pwm_[i]) ledcAttachPin(pins[i], i);
+#endif
+        if (!pwm_[i]) {
+            pinMode(pins[i], OUTPUT);   // 3.x: digitalWrite sebelum pinMode diabaikan
+            digitalWrite(pins[i], LOW);
+        }
+    }
+}
+
+void LedcRelayOutput::write(uint8_t relay, uint16_t duty) {
+    if (relay >= count_) return;
+
+    if (!pwm_[relay]) {
+        digitalWrite(pins_[relay], duty > 0 ? HIGH : LOW);
+        return;
+    }
+#if defined(ESP_ARDUINO_VERSION_MAJOR) && ESP_ARDUINO_VERSION_MAJOR >= 3
+    ledcWrite(pins_[relay], duty);
+#else
+    ledcWrite(relay, duty);    // 2.x: duty == max → otomatis full on
+#endif
+}
+#endif
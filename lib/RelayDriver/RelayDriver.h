@@ -0,0 +1,124 @@
+#pragma once
+// ======================================================================
+//  RELAY DRIVER (coil economizer)
+//  Relay butuh arus penuh cuma untuk menarik armature (pull-in); setelah
+//  nempel cukup ditahan dengan tegangan rata-rata lebih kecil. Tiap relay
+//  dapat channel LEDC sendiri: ON = duty penuh selama pullInMs, lalu turun
+//  ke holdDuty lewat deadline di DeadlineWheel (tepat waktu, tidak ikut
+//  loop()).
+//
+//  Daya coil ~ V² / R, jadi beban ke aki pada duty d ≈ d² × full drive
+//  (arus coil ≈ d × I_full, diambil dari aki cuma selama d). Dioda
+//  flyback di coil wajib, tanpa itu PWM merusak transistor driver.
+//
+//  Output lewat RelayOutput supaya simulasi host (tools/relay_sim) bisa
+//  rekam waveform dengan VirtualDeadlineClock.
+// ======================================================================
+#include <stdint.h>
+#include "DeadlineWheel.h"
+
+#define RELAY_DRIVER_MAX   3
+#define RELAY_PWM_FREQ_HZ  20000   // di atas pendengaran, coil tidak berdengung
+#define RELAY_PWM_BITS     10
+#define RELAY_PWM_MAX      ((1u << RELAY_PWM_BITS) - 1)
+
+// Fraksi daya coil terhadap full drive pada duty PWM d (0..1).
+inline float relayCoilWeight(float duty) { return duty * duty; }
+
+struct RelayProfile {
+    uint16_t pullInMs;   // duty penuh sejak ON
+    float    holdDuty;   // 0..1; >= 1.0 → tanpa PWM (full drive terus)
+};
+
+// Profil relay motor, urut EnergyRelay (CONTACT, SEIN, HORN). Satu
+// sumber untuk firmware dan tools/relay_sim.
+static const RelayProfile RELAY_PROFILES[RELAY_DRIVER_MAX] = {
+    { 60, 0.50f },   // CONTACT: ON 3–7 detik, paling banyak hemat
+    { 40, 0.60f },   // SEIN   : pulsa 120 ms
+    { 50, 0.60f }    // HORN   : pulsa 300 ms
+};
+
+struct RelayStats {
+    uint64_t onUs;       // total waktu relay ON
+    uint64_t driveUs;    // waktu ekuivalen full drive (bobot d²)
+    uint32_t activations;
+};
+
+// duty 0..RELAY_PWM_MAX, RELAY_PWM_MAX = full on
+class RelayOutput {
+public:
+    virtual ~RelayOutput() {}
+    virtual void write(uint8_t relay, uint16_t duty) = 0;
+};
+
+// Dipanggil tiap level drive berubah (ON, pull-in → hold, OFF).
+// Bisa dari konteks timer: harus singkat.
+typedef void (*RelayDriveHook)(uint8_t relay, float weight, void* arg);
+
+class RelayDriver {
+public:
+    // Relay i pakai deadline id firstTimerId + i.
+    void begin(RelayOutput* out, DeadlineWheel* wheel, uint8_t firstTimerId, uint8_t count);
+
+    void setProfile(uint8_t relay, const RelayProfile& p);
+    void setHook(RelayDriveHook hook, void* arg = nullptr) { hook_ = hook; hookArg_ = arg; }
+
+    void on(uint8_t relay);
+    void off(uint8_t relay);   // aman dari callback deadline lain
+
+    bool  isOn(uint8_t relay) const { return relay < count_ && state_[relay] != STATE_OFF; }
+    bool  holding(uint8_t relay) const { return relay < count_ && state_[relay] == STATE_HOLD; }
+
+    // Statistik sejak resetStats(); waktu berjalan ikut dihitung.
+    void stats(uint8_t relay, RelayStats& out);
+    void resetStats();
+
+private:
+    enum State : uint8_t { STATE_OFF, STATE_PULL_IN, STATE_HOLD };
+
+    static void onHoldDeadline(uint8_t id, void* arg);
+
+    void  lock();
+    void  unlock();
+    void  accountLocked(uint8_t relay, uint64_t nowUs);
+    void  driveLocked(uint8_t relay, State s, uint64_t nowUs);
+    float dutyOf(uint8_t relay, State s) const;
+
+    RelayOutput*   out_     = nullptr;
+    DeadlineWheel* wheel_   = nullptr;
+    uint8_t        firstId_ = 0;
+    uint8_t        count_   = 0;
+    RelayDriveHook hook_    = nullptr;
+    void*          hookArg_ = nullptr;
+
+    RelayProfile   profile_[RELAY_DRIVER_MAX] = {};
+    volatile State state_[RELAY_DRIVER_MAX]   = {};
+    uint64_t       holdAtUs_[RELAY_DRIVER_MAX] = {};   // deadline lama yang telat fire diabaikan
+    uint64_t       lastUs_[RELAY_DRIVER_MAX]   = {};
+    RelayStats     stats_[RELAY_DRIVER_MAX]    = {};
+#ifdef ESP_PLATFORM
+    portMUX_TYPE   mux_ = portMUX_INITIALIZER_UNLOCKED;
+#endif
+};
+
+#ifdef ESP_PLATFORM
+// LEDC channel 0..count-1. Di Arduino-ESP32 2.x dan 3.x timer LEDC =
+// channel / 2, jadi channel count-1 dan pasangannya berbagi timer: user
+// LEDC lain di channel itu mengubah frekuensi/resolusi relay (hold 20 kHz
+// rusak). analogWrite() 2.x ambil channel dari atas, tapi 3.x ambil channel
+// bebas pertama (= count) → pakai RELAY_LEDC_FREE_CHANNEL(count) atau
+// frekuensi/resolusi yang sama. Kalau LEDC gagal di-setup, pin itu jatuh
+// ke digitalWrite (duty > 0 = HIGH).
+#define RELAY_LEDC_FREE_CHANNEL(count) ((((count) + 1) / 2) * 2)   // timer sendiri
+
+class LedcRelayOutput : public RelayOutput {
+public:
+    void begin(const uint8_t* pins, uint8_t count);
+    void write(uint8_t relay, uint16_t duty) override;
+
+private:
+    uint8_t pins_[RELAY_DRIVER_MAX] = {};
+    bool    pwm_[RELAY_DRIVER_MAX]  = {};
+    uint8_t count_ = 0;
+};
+#endif
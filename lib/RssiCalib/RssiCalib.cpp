@@ -0,0 +1,192 @@
+#include "RssiCalib.h"
+#include <string.h>
+
+static inline int clampInt(int v, int lo, int hi) {
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+// ======================================================================
+//  HISTOGRAM
+// ======================================================================
+void RssiHistogram::add(float rssi) {
+    int bin = (int)(rssi - RSSI_HIST_MIN_DBM) / RSSI_HIST_BIN_DB;
+    bin = clampInt(bin, 0, RSSI_HIST_BINS - 1);
+
+    bins[bin]++;
+    total++;
+
+    // Sampel lama pelan-pelan kalah → ikut berubah kalau key/antena dipindah
+    if (total >= RSSI_HIST_DECAY_TOTAL) halve();
+}
+
+void RssiHistogram::halve() {
+    uint16_t t = 0;
+    for (uint8_t i = 0; i < RSSI_HIST_BINS; ++i) {
+        bins[i] >>= 1;
+        t += bins[i];
+    }
+    total = t;
+}
+
+int8_t RssiHistogram::percentile(float p) const {
+    uint32_t need = (uint32_t)(p * (float)total);
+    uint32_t acc  = 0;
+    for (uint8_t i = 0; i < RSSI_HIST_BINS; ++i) {
+        acc += bins[i];
+        if (acc > need) return (int8_t)(RSSI_HIST_MIN_DBM + i * RSSI_HIST_BIN_DB);
+    }
+    return (int8_t)(RSSI_HIST_MIN_DBM + (RSSI_HIST_BINS - 1) * RSSI_HIST_BIN_DB);
+}
+
+uint16_t RssiHistogram::countAtLeast(int8_t dbm) const {
+    uint16_t n = 0;
+    for (uint8_t i = 0; i < RSSI_HIST_BINS; ++i) {
+        if (RSSI_HIST_MIN_DBM + i * RSSI_HIST_BIN_DB >= dbm) n += bins[i];
+    }
+    return n;
+}
+
+// ======================================================================
+//  KALIBRASI PER KEY
+// ======================================================================
+void RssiCalib::begin(int8_t defaultNear, int8_t defaultFar) {
+    defNear_ = defaultNear;
+    defFar_  = defaultFar;
+    for (uint8_t k = 0; k < RSSI_CALIB_MAX_KEYS; ++k) {
+        near_[k]  = RssiHistogram{};
+        far_[k]   = RssiHistogram{};
+        dirty_[k] = false;
+        pending_[k] = false;
+        recompute(k);
+    }
+}
+
+bool RssiCalib::notePress(uint8_t key, uint32_t nowMs, float rssi, bool unlocked) {
+    if (key >= RSSI_CALIB_MAX_KEYS) return false;
+    if (unlocked) {
+        pending_[key] = false;
+        noteUnlock(key, rssi);
+        return true;
+    }
+    pending_[key]     = true;
+    pendingMs_[key]   = nowMs;
+    pendingRssi_[key] = rssi;
+    return false;
+}
+
+bool RssiCalib::noteClick(uint8_t key, uint32_t nowMs) {
+    if (key >= RSSI_CALIB_MAX_KEYS || !pending_[key]) return false;
+    pending_[key] = false;
+    if (nowMs - pendingMs_[key] > RSSI_CALIB_CONFIRM_MS) return false;
+    noteUnlock(key, pendingRssi_[key]);
+    return true;
+}
+
+void RssiCalib::noteUnlock(uint8_t key, float rssi) {
+    if (key >= RSSI_CALIB_MAX_KEYS) return;
+    near_[key].add(rssi);
+    dirty_[key] = true;
+    recompute(key);
+}
+
+void RssiCalib::noteFar(uint8_t key, float rssi) {
+    if (key >= RSSI_CALIB_MAX_KEYS) return;
+    far_[key].add(rssi);
+    dirty_[key] = true;
+    recompute(key);
+}
+
+void RssiCalib::recompute(uint8_t key) {
+    const RssiHistogram& nh = near_[key];
+    const RssiHistogram& fh = far_[key];
+    RssiThresholds&      th = th_[key];
+
+    if (nh.total < RSSI_CALIB_MIN_NEAR) {
+        th.nearDbm    = defNear_;
+        th.farDbm     = defFar_;
+        th.calibrated = false;
+        return;
+    }
+
+    // Apa pun isi histogram, near tidak boleh jauh lebih longgar dari default
+    int loosest = defNear_ - RSSI_CALIB_MAX_LOOSEN_DB;
+    if (loosest < RSSI_CALIB_NEAR_MIN) loosest = RSSI_CALIB_NEAR_MIN;
+
+    // 90% unlock yang sudah terjadi harus lolos threshold ini
+    int nearP10 = nh.percentile(0.10f);
+    int nearTh;
+
+    if (fh.total >= RSSI_CALIB_MIN_FAR) {
+        int farTop = fh.percentile(0.95f) + RSSI_HIST_BIN_DB;
+        int wanted = nearP10 < loosest ? loosest : nearP10;
+
+        if (wanted >= farTop + RSSI_CALIB_FAR_GUARD) {
+            nearTh = wanted;
+        } else {
+            // Distribusi tumpang tindih: tidak ada ruang untuk melonggar, jadi
+            // kandidat cuma batas bin asli yang sama/lebih ketat dari default,
+            // dari yang paling ketat. False unlock 2x lebih mahal dari gagal unlock.
+            float bestCost = 1e9f;
+            nearTh = defNear_;
+            for (int i = RSSI_HIST_BINS - 1; i >= 0; --i) {
+                int t = RSSI_HIST_MIN_DBM + i * RSSI_HIST_BIN_DB;
+                if (t > RSSI_CALIB_NEAR_MAX) continue;
+                if (t < defNear_) break;
+                float missed = 1.0f - (float)nh.countAtLeast((int8_t)t) / (float)nh.total;
+                float falseU = (float)fh.countAtLeast((int8_t)t) / (float)fh.total;
+                float cost   = missed + 2.0f * falseU;
+                if (cost < bestCost) {   // seri → tetap yang lebih ketat
+                    bestCost = cost;
+                    nearTh   = t;
+                }
+            }
+        }
+    } else {
+        // Belum ada bukti jauh: boleh lebih ketat, tidak boleh melonggar
+        nearTh = nearP10 < defNear_ ? defNear_ : nearP10;
+    }
+
+    nearTh = clampInt(nearTh, loosest, RSSI_CALIB_NEAR_MAX);
+
+    // Hysteresis ikut sebaran sampel unlock (median - p10)
+    int hyst = (nh.percentile(0.50f) - nearP10) / 2;
+    hyst = clampInt(hyst, RSSI_CALIB_HYST_MIN, RSSI_CALIB_HYST_MAX);
+
+    // Band hysteresis juga menahan NEAR: jangan sampai sampel far yang masih
+    // di atas farDbm lebih banyak dari batas far default
+    uint16_t farAboveDefault = fh.countAtLeast((int8_t)(defFar_ + 1));
+    while (hyst > RSSI_CALIB_HYST_MIN &&
+           fh.countAtLeast((int8_t)(nearTh - hyst + 1)) > farAboveDefault) {
+        hyst--;
+    }
+
+    th.nearDbm    = (int8_t)nearTh;
+    th.farDbm     = (int8_t)(nearTh - hyst);
+    th.calibrated = true;
+}
+
+// ======================================================================
+//  PERSISTENSI
+// ======================================================================
+void RssiCalib::record(uint8_t key, RssiCalibRecord& out) {
+    memset(&out, 0, sizeof(out));
+    out.magic    = RSSI_CALIB_MAGIC;
+    out.version  = RSSI_CALIB_VERSION;
+    out.keyIndex = key;
+    if (key >= RSSI_CALIB_MAX_KEYS) return;
+
+    out.nearHist = near_[key];
+    out.farHist  = far_[key];
+    dirty_[key]  = false;
+}
+
+bool RssiCalib::restore(const RssiCalibRecord& in) {
+    if (in.magic != RSSI_CALIB_MAGIC || in.version != RSSI_CALIB_VERSION) return false;
+    if (in.keyIndex >= RSSI_CALIB_MAX_KEYS) return false;
+
+    near_[in.keyIndex]  = in.nearHist;
+    far_[in.keyIndex]   = in.farHist;
+    dirty_[in.keyIndex] = false;
+    recompute(in.keyIndex);
+    return true;
+}
@@ -0,0 +1,106 @@
+#pragma once
+// ======================================================================
+//  RSSI AUTO-CALIBRATION
+//  Threshold NEAR/FAR per key dipelajari dari kejadian yang pasti:
+//    - near : trigger ditekan DAN (unlock terjadi, atau dikonfirmasi klik
+//             iTAG key itu dalam RSSI_CALIB_CONFIRM_MS). Trigger sendiri
+//             input fisik tanpa autentikasi: siapa pun di motor bisa
+//             menekannya saat key pemilik connect dari jauh, jadi tekan
+//             yang tidak terbukti tidak pernah jadi sampel.
+//    - far  : link putus karena supervision timeout (tepi jangkauan), plus
+//             sampel "parkir" dari firmware: key connect, tidak NEAR, tanpa
+//             trigger/klik/kontak lama (bukan tepi jangkauan).
+//  RSSI rata-rata pada momen itu masuk histogram bin tetap per key, lalu
+//  threshold dihitung ulang dari histogram (dengan batas aman). Threshold
+//  near hanya melonggar kalau ada >= RSSI_CALIB_MIN_FAR sampel far yang
+//  terpisah jelas, dan tidak pernah lewat default - RSSI_CALIB_MAX_LOOSEN_DB.
+//
+//  Tanpa Arduino.h: dipakai juga oleh tools/rssi_calib_eval untuk replay
+//  trace. Penyimpanan (Preferences/NVS) diurus firmware lewat RssiCalibRecord.
+// ======================================================================
+#include <stdint.h>
+
+#define RSSI_CALIB_MAX_KEYS   4
+#define RSSI_HIST_MIN_DBM     (-100)
+#define RSSI_HIST_BIN_DB      2
+#define RSSI_HIST_BINS        30          // -100 .. -40 dBm
+#define RSSI_HIST_DECAY_TOTAL 200         // total sampel → semua bin dibagi 2
+
+// Batas hasil kalibrasi: di luar ini dianggap data aneh, bukan antena
+#define RSSI_CALIB_NEAR_MIN   (-85)
+#define RSSI_CALIB_NEAR_MAX   (-55)
+#define RSSI_CALIB_HYST_MIN   1
+#define RSSI_CALIB_HYST_MAX   6
+#define RSSI_CALIB_FAR_GUARD  3           // dB di atas p95 sampel far
+#define RSSI_CALIB_MIN_NEAR   6           // sampel unlock minimal
+#define RSSI_CALIB_MIN_FAR    10          // sampel far minimal (sebelum boleh melonggar)
+#define RSSI_CALIB_MAX_LOOSEN_DB 6        // batas mutlak longgar dari default
+#define RSSI_CALIB_CONFIRM_MS 10000       // klik iTAG setelah trigger = bukti pegang key
+
+struct RssiHistogram {
+    uint16_t bins[RSSI_HIST_BINS];
+    uint16_t total;
+
+    void   add(float rssi);
+    void   halve();
+    // Batas bawah bin tempat fraksi p (0..1) sampel terlewati.
+    int8_t percentile(float p) const;
+    // Jumlah sampel dengan RSSI >= dbm (per bin, bin dihitung dari batas bawah).
+    uint16_t countAtLeast(int8_t dbm) const;
+};
+
+struct RssiThresholds {
+    int8_t nearDbm;      // avg >= ini → NEAR
+    int8_t farDbm;       // avg <= ini → FAR (hysteresis)
+    bool   calibrated;   // false = masih default
+};
+
+// Blob untuk NVS, satu per key.
+struct RssiCalibRecord {
+    uint16_t      magic;
+    uint8_t       version;
+    uint8_t       keyIndex;
+    RssiHistogram nearHist;
+    RssiHistogram farHist;
+};
+
+#define RSSI_CALIB_MAGIC   0xCA1Bu
+#define RSSI_CALIB_VERSION 1
+
+class RssiCalib {
+public:
+    void begin(int8_t defaultNear, int8_t defaultFar);
+
+    // Trigger ditekan saat key connect. unlocked → langsung sampel near;
+    // kalau tidak, ditahan sampai noteClick() key yang sama dalam
+    // RSSI_CALIB_CONFIRM_MS. Return true kalau sampel dicatat sekarang.
+    bool notePress(uint8_t key, uint32_t nowMs, float rssi, bool unlocked);
+    // Klik tombol iTAG key ini; mengonfirmasi trigger yang ditahan.
+    bool noteClick(uint8_t key, uint32_t nowMs);
+
+    void noteUnlock(uint8_t key, float rssi);
+    void noteFar(uint8_t key, float rssi);
+
+    const RssiThresholds& thresholds(uint8_t key) const { return th_[key]; }
+    const RssiHistogram&  nearHist(uint8_t key) const   { return near_[key]; }
+    const RssiHistogram&  farHist(uint8_t key) const    { return far_[key]; }
+
+    // Persistensi: dirty di-set tiap ada sampel baru, clear waktu disimpan.
+    bool dirty(uint8_t key) const    { return dirty_[key]; }
+    void record(uint8_t key, RssiCalibRecord& out);
+    bool restore(const RssiCalibRecord& in);
+
+private:
+    void recompute(uint8_t key);
+
+    int8_t         defNear_ = -71;
+    int8_t         defFar_  = -72;
+    RssiHistogram  near_[RSSI_CALIB_MAX_KEYS] = {};
+    RssiHistogram  far_[RSSI_CALIB_MAX_KEYS]  = {};
+    RssiThresholds th_[RSSI_CALIB_MAX_KEYS]   = {};
+    bool           dirty_[RSSI_CALIB_MAX_KEYS] = {};
+    // Trigger yang menunggu konfirmasi klik iTAG
+    bool           pending_[RSSI_CALIB_MAX_KEYS]     = {};
+    uint32_t       pendingMs_[RSSI_CALIB_MAX_KEYS]   = {};
+    float          pendingRssi_[RSSI_CALIB_MAX_KEYS] = {};
+};
@@ -0,0 +1,133 @@
+#include "Telemetry.h"
+#include <string.h>
+
+static inline void put16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void put32(uint8_t* p, uint32_t v) {
+    put16(p, (uint16_t)v);
+    put16(p + 2, (uint16_t)(v >> 16));
+}
+
+static inline uint16_t get16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t get32(const uint8_t* p) {
+    return (uint32_t)get16(p) | ((uint32_t)get16(p + 2) << 16);
+}
+
+// ======================================================================
+//  STATUS
+// ======================================================================
+size_t telemetryEncodeStatus(const TelemetryStatus& s, uint8_t* buf) {
+    buf[0]  = TELEMETRY_TYPE_STATUS;
+    buf[1]  = TELEMETRY_VERSION;
+    buf[2]  = s.flags;
+    buf[3]  = (uint8_t)s.rssiAvg;
+    buf[4]  = (uint8_t)s.nearDbm;
+    buf[5]  = (uint8_t)s.farDbm;
+    buf[6]  = s.batteryPercent;
+    buf[7]  = s.sessionCount;
+    buf[8]  = (uint8_t)s.nearestKey;
+    buf[9]  = s.manualState;
+    buf[10] = s.activationCount;
+    return TELEMETRY_STATUS_LEN;
+}
+
+bool telemetryDecodeStatus(const uint8_t* buf, size_t len, TelemetryStatus& out) {
+    if (len < TELEMETRY_STATUS_LEN || buf[0] != TELEMETRY_TYPE_STATUS ||
+        buf[1] != TELEMETRY_VERSION) {
+        return false;
+    }
+    out.flags           = buf[2];
+    out.rssiAvg         = (int8_t)buf[3];
+    out.nearDbm         = (int8_t)buf[4];
+    out.farDbm          = (int8_t)buf[5];
+    out.batteryPercent  = buf[6];
+    out.sessionCount    = buf[7];
+    out.nearestKey      = (int8_t)buf[8];
+    out.manualState     = buf[9];
+    out.activationCount = buf[10];
+    return true;
+}
+
+// ======================================================================
+//  COUNTERS
+// ======================================================================
+size_t telemetryEncodeCounters(const TelemetryCounters& c, uint8_t* buf) {
+    buf[0] = TELEMETRY_TYPE_COUNTERS;
+    buf[1] = TELEMETRY_VERSION;
+    put16(buf + 2,  c.bootCount);
+    put16(buf + 4,  c.connects);
+    put16(buf + 6,  c.disconnects);
+    put16(buf + 8,  c.connectFails);
+    put16(buf + 10, c.supervisionTimeouts);
+    put16(buf + 12, c.unlocks);
+    put16(buf + 14, c.triggerPresses);
+    put16(buf + 16, c.itagClicks);
+    put32(buf + 18, c.contactLateMaxUs);
+    put32(buf + 22, c.notifies);          // TELEMETRY_COUNTERS_CMP = 22
+    put32(buf + 26, c.freeHeap);
+    put32(buf + 30, c.uptimeS);
+    return TELEMETRY_COUNTERS_LEN;
+}
+
+bool telemetryDecodeCounters(const uint8_t* buf, size_t len, TelemetryCounters& out) {
+    if (len < TELEMETRY_COUNTERS_LEN || buf[0] != TELEMETRY_TYPE_COUNTERS ||
+        buf[1] != TELEMETRY_VERSION) {
+        return false;
+    }
+    out.bootCount           = get16(buf + 2);
+    out.connects            = get16(buf + 4);
+    out.disconnects         = get16(buf + 6);
+    out.connectFails        = get16(buf + 8);
+    out.supervisionTimeouts = get16(buf + 10);
+    out.unlocks             = get16(buf + 12);
+    out.triggerPresses      = get16(buf + 14);
+    out.itagClicks          = get16(buf + 16);
+    out.contactLateMaxUs    = get32(buf + 18);
+    out.notifies            = get32(buf + 22);
+    out.freeHeap            = get32(buf + 26);
+    out.uptimeS             = get32(buf + 30);
+    return true;
+}
+
+// ======================================================================
+//  COALESCER
+// ======================================================================
+void TelemetryCoalescer::begin(uint16_t minIntervalMs, uint16_t heartbeatMs, uint8_t compareLen) {
+    minInterval_ = minIntervalMs;
+    heartbeat_   = heartbeatMs;
+    compareLen_  = compareLen > TELEMETRY_MAX_LEN ? TELEMETRY_MAX_LEN : compareLen;
+    lastLen_     = 0;
+    primed_      = false;
+}
+
+bool TelemetryCoalescer::offer(uint32_t nowMs, const uint8_t* rec, uint8_t len) {
+    if (len > TELEMETRY_MAX_LEN) return false;
+
+    uint32_t since = nowMs - lastMs_;
+    bool send;
+
+    if (!primed_) {
+        send = true;
+    } else if (since >= heartbeat_) {
+        send = true;
+    } else if (since < minInterval_) {
+        send = false;   // perubahan ditahan, terkirim di offer() berikutnya
+    } else {
+        uint8_t cmp = compareLen_ < len ? compareLen_ : len;
+        send = (len != lastLen_) || memcmp(rec, last_, cmp) != 0;
+    }
+
+    if (send) {
+        memcpy(last_, rec, len);
+        lastLen_ = len;
+        lastMs_  = nowMs;
+        primed_  = true;
+    }
+    return send;
+}
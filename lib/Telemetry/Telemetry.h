@@ -0,0 +1,101 @@
+#pragma once
+// ======================================================================
+//  TELEMETRY (GATT diagnosa)
+//  Dua record biner kecil, byte per byte little-endian (tidak tergantung
+//  packing struct), dikirim lewat characteristic READ|NOTIFY:
+//    - status   : state kontrol sekarang (jarak, kontak, scan, manual)
+//    - counters : hitungan event sejak boot
+//  Byte 0 = tipe record, byte 1 = versi → decoder bisa tebak sendiri.
+//  Progress input kode manual (digit benar / klik) sengaja tidak ikut:
+//  record ini bisa dibaca siapa pun yang sudah pairing, bukan cuma pemilik.
+//
+//  TelemetryCoalescer memutuskan kapan notify: hanya kalau isi berubah,
+//  paling cepat tiap minIntervalMs, plus heartbeat walau tidak berubah.
+//
+//  Tanpa Arduino.h: dipakai juga oleh tools/telemetry_decode dan
+//  tools/telemetry_loopback.
+// ======================================================================
+#include <stddef.h>
+#include <stdint.h>
+
+#define TELEMETRY_SERVICE_UUID  "5c0b0001-4d6f-746f-7253-43554b657931"
+#define TELEMETRY_STATUS_UUID   "5c0b0002-4d6f-746f-7253-43554b657931"
+#define TELEMETRY_COUNTERS_UUID "5c0b0003-4d6f-746f-7253-43554b657931"
+
+#define TELEMETRY_VERSION         2   // v2: manualIndex/digitPressCount dibuang
+#define TELEMETRY_TYPE_STATUS     1
+#define TELEMETRY_TYPE_COUNTERS   2
+
+#define TELEMETRY_STATUS_LEN      11
+#define TELEMETRY_COUNTERS_LEN    34
+// Bagian counters yang dibandingkan coalescer; sisanya (notify, heap,
+// uptime) berubah terus dan cuma ikut heartbeat / perubahan lain.
+#define TELEMETRY_COUNTERS_CMP    22
+#define TELEMETRY_MAX_LEN         TELEMETRY_COUNTERS_LEN
+
+// Flag status
+#define TELEMETRY_F_CONNECTED   0x01
+#define TELEMETRY_F_NEAR        0x02
+#define TELEMETRY_F_CONTACT     0x04
+#define TELEMETRY_F_SCAN_SLOW   0x08
+#define TELEMETRY_F_BATT_LOW    0x10
+#define TELEMETRY_F_MANUAL      0x20   // triple trigger terdeteksi
+#define TELEMETRY_F_CALIBRATED  0x40   // threshold key terdekat hasil kalibrasi
+
+#define TELEMETRY_BATTERY_UNKNOWN 0xFF
+#define TELEMETRY_RSSI_NONE       (-128)
+
+struct TelemetryStatus {
+    uint8_t flags;
+    int8_t  rssiAvg;           // dBm, key terdekat
+    int8_t  nearDbm;           // threshold aktif key terdekat
+    int8_t  farDbm;
+    uint8_t batteryPercent;    // 0xFF = belum tahu
+    uint8_t sessionCount;
+    int8_t  nearestKey;        // -1 = tidak ada
+    uint8_t manualState;       // 0 idle, 1 input kode
+    uint8_t activationCount;   // trigger menuju mode manual
+};
+
+struct TelemetryCounters {
+    uint16_t bootCount;
+    uint16_t connects;
+    uint16_t disconnects;
+    uint16_t connectFails;
+    uint16_t supervisionTimeouts;
+    uint16_t unlocks;
+    uint16_t triggerPresses;
+    uint16_t itagClicks;
+    uint32_t contactLateMaxUs;   // telat maksimum deadline CONTACT OFF
+    // --- tidak dibandingkan coalescer ---
+    uint32_t notifies;
+    uint32_t freeHeap;
+    uint32_t uptimeS;
+};
+
+size_t telemetryEncodeStatus(const TelemetryStatus& s, uint8_t* buf);
+size_t telemetryEncodeCounters(const TelemetryCounters& c, uint8_t* buf);
+
+// false kalau tipe/versi/panjang tidak cocok.
+bool telemetryDecodeStatus(const uint8_t* buf, size_t len, TelemetryStatus& out);
+bool telemetryDecodeCounters(const uint8_t* buf, size_t len, TelemetryCounters& out);
+
+class TelemetryCoalescer {
+public:
+    void begin(uint16_t minIntervalMs, uint16_t heartbeatMs, uint8_t compareLen);
+
+    // true → record harus dikirim sekarang (disimpan sebagai terakhir terkirim).
+    bool offer(uint32_t nowMs, const uint8_t* rec, uint8_t len);
+
+    // Paksa kirim di offer() berikutnya (mis. client baru subscribe).
+    void resync() { primed_ = false; }
+
+private:
+    uint8_t  last_[TELEMETRY_MAX_LEN] = {};
+    uint8_t  lastLen_     = 0;
+    uint8_t  compareLen_  = 0;
+    uint16_t minInterval_ = 200;
+    uint16_t heartbeat_   = 5000;
+    uint32_t lastMs_      = 0;
+    volatile bool primed_ = false;
+};
@@ -1,13 +1,30 @@
 #include <Arduino.h>
 #include <NimBLEDevice.h>
 #include <cstring>  // untuk memcmp manufacturer data
+#include <esp_timer.h>
+#include <esp_system.h>
+#include <Preferences.h>
+#include "EnergyProfiler.h"
+#include "BootTiming.h"
+#include "AdvTable.h"
+#include "DeadlineWheel.h"
+#include "AllocCounter.h"
+#include "RssiCalib.h"
+#include "RelayDriver.h"
+#include "Telemetry.h"
+#include "NotifyRoutes.h"
 
 // ======================================================================
 //  OPSI MODE / DEBUG
 // ======================================================================
 
 // #define ScanForGetMac
+// #define ScanDumpBinary   // ScanForGetMac: ringkasan dikirim biner (tools/adv_dump)
 // #define ReadMessage
+// #define LogRssiTrace     // CSV [TRACE] untuk tools/rssi_calib_eval
+// #define TelemetryGatt    // GATT status/counters untuk HP servis (read-only,
+                            // wajib pairing passkey; TELEMETRY_PASSKEY dari
+                            // build flag, lihat platformio.ini)
 
 #define DEBUG_VERBOSE 0
 
@@ -26,44 +43,87 @@
 // ======================================================================
 #ifdef ScanForGetMac
 
+const unsigned long SUMMARY_INTERVAL_MS = 5000;
+const unsigned long ADV_EXPIRE_MS       = 30000;   // device hilang dari tabel
+
+// onResult (task NimBLE) cuma update tabel; semua output dari loop()
+AdvTable     advTable;
+portMUX_TYPE advMux = portMUX_INITIALIZER_UNLOCKED;
+
+// static supaya snapshot ~8 KB tidak makan stack loopTask
+static AdvTable advSnapshot;
+static uint16_t advOrder[ADV_TABLE_CAPACITY];
+#ifdef ScanDumpBinary
+static uint8_t  advFrame[ADV_DUMP_FRAME_MAX];
+#endif
+
 class ScanCallbacks : public NimBLEScanCallbacks {
     void onResult(const NimBLEAdvertisedDevice* dev) override {
-        String addr = dev->getAddress().toString().c_str();
-        String name = dev->haveName() ? dev->getName().c_str() : String("<no name>");
-        int rssi = dev->getRSSI();
-
-        Serial.printf("Device: %-20s  MAC: %s  RSSI: %d dBm\n",
-                      name.c_str(), addr.c_str(), rssi);
-
-        if (dev->haveServiceUUID()) {
-            Serial.print("  Services: ");
-            uint8_t count = dev->getServiceUUIDCount();
-            for (uint8_t i = 0; i < count; ++i) {
-                NimBLEUUID u = dev->getServiceUUID(i);
-                Serial.print(u.toString().c_str());
-                if (i < count - 1) Serial.print(", ");
-            }
-            Serial.println();
-        }
+        const std::vector<uint8_t>& payload = dev->getPayload();
 
-        std::string mfg = dev->getManufacturerData();
-        if (!mfg.empty()) {
-            Serial.print("  MFG: ");
-            for (size_t i = 0; i < mfg.size(); ++i) {
-                Serial.printf("%02X ", (uint8_t)mfg[i]);
-            }
-            Serial.println();
+        AdvSample s;
+        if (!advParsePayload(payload.data(), payload.size(), s)) {
+            portENTER_CRITICAL(&advMux);
+            advTable.noteParseError();
+            portEXIT_CRITICAL(&advMux);
+            return;
         }
 
-        Serial.println();
+        const NimBLEAddress& addr = dev->getAddress();
+        memcpy(s.addr, addr.getVal(), sizeof(s.addr));
+        s.addrType = addr.getType();
+        s.rssi     = (int8_t)dev->getRSSI();
+
+        unsigned long nowMs = millis();
+        portENTER_CRITICAL(&advMux);
+        advTable.update(s, nowMs);
+        portEXIT_CRITICAL(&advMux);
     }
 
     void onScanEnd(const NimBLEScanResults& results, int reason) override {
+        portENTER_CRITICAL(&advMux);
+        advTable.noteScanRestart();
+        portEXIT_CRITICAL(&advMux);
         Serial.println("Scan ended, restarting...");
         NimBLEDevice::getScan()->start(0, true, false);
     }
 } scanCallbacks;
 
+void printSummary(uint16_t n, uint32_t windowMs, const AdvStats& win) {
+    Serial.printf("\n=== SCAN SUMMARY %.1f s: %u device | %.0f adv/s diproses ===\n",
+                  windowMs / 1000.0f, n, win.processed * 1000.0f / windowMs);
+    Serial.printf("    dibuang: %lu parse gagal, %lu tabel penuh | scan restart %lu\n",
+                  (unsigned long)win.parseErrors, (unsigned long)win.tableFull,
+                  (unsigned long)win.scanRestarts);
+    Serial.printf("    %lu device diganti (tabel penuh, bukan advert hilang)\n",
+                  (unsigned long)win.evicted);
+    Serial.println("MAC                type  count  min  avg  max  name                 services / MFG");
+
+    for (uint16_t k = 0; k < n; ++k) {
+        const AdvEntry& e = advSnapshot.slot(advOrder[k]);
+
+        Serial.printf("%02x:%02x:%02x:%02x:%02x:%02x  %u  %6lu %4d %4d %4d  %-20.*s",
+                      e.addr[5], e.addr[4], e.addr[3], e.addr[2], e.addr[1], e.addr[0],
+                      e.addrType, (unsigned long)e.count,
+                      e.rssiMin, e.rssiMean(), e.rssiMax,
+                      (int)e.nameLen, e.nameLen ? e.name : "<no name>");
+
+        for (uint8_t u = 0; u < e.uuidCount; ++u) {
+            Serial.print(u ? "," : " ");
+            for (int b = e.uuids[u].len - 1; b >= 0; --b) {
+                Serial.printf("%02x", e.uuids[u].val[b]);
+            }
+        }
+        if (e.mfgLen) {
+            Serial.print(" MFG:");
+            for (uint8_t b = 0; b < e.mfgLen; ++b) {
+                Serial.printf("%02X", e.mfg[b]);
+            }
+        }
+        Serial.println();
+    }
+}
+
 void setup() {
     Serial.begin(115200);
     Serial.println("=== ESP32-C3 SCAN FOR GET MAC / SERVICE / MFG ===");
@@ -78,11 +138,14 @@ void setup() {
     scan->setInterval(45);
     scan->setWindow(30);
     scan->setActiveScan(true);
+    scan->setDuplicateFilter(false);   // semua advert dihitung, bukan cuma yang pertama
+    scan->setMaxResults(0);            // tabel sendiri; NimBLE tetap alokasi per advert
     scan->start(0, true, false);
 }
 
 void loop() {
-    static unsigned long lastBlink = 0;
+    static unsigned long lastBlink     = 0;
+    static unsigned long lastSummaryMs = 0;
     static bool led = false;
     unsigned long now = millis();
 
@@ -92,6 +155,28 @@ void loop() {
         digitalWrite(LED_BUILTIN, led ? LOW : HIGH);
     }
 
+    if (now - lastSummaryMs >= SUMMARY_INTERVAL_MS) {
+        uint32_t windowMs = now - lastSummaryMs;
+        lastSummaryMs = now;
+
+        // snapshot = window yang baru selesai; tabel mulai window baru
+        portENTER_CRITICAL(&advMux);
+        advSnapshot = advTable;
+        advTable.beginWindow(now, ADV_EXPIRE_MS);
+        portEXIT_CRITICAL(&advMux);
+
+        const AdvStats& win = advSnapshot.stats();
+
+        uint16_t n = advSnapshot.sortedByRssi(advOrder, ADV_TABLE_CAPACITY);
+#ifdef ScanDumpBinary
+        size_t len = advEncodeFrame(advSnapshot, advOrder, n, windowMs, win,
+                                    advFrame, sizeof(advFrame));
+        Serial.write(advFrame, len);
+#else
+        printSummary(n, windowMs, win);
+#endif
+    }
+
     delay(50);
 }
 
@@ -102,14 +187,18 @@ void loop() {
 //  KONFIGURASI BLE / ITAG
 // ======================================================================
 
-static const char* TARGET_MAC  = "f4:a9:05:54:53:48";
-
 static const uint16_t ITAG_SERVICE_UUID = 0xFFE0;
 static const uint16_t ITAG_CHAR_UUID    = 0xFFE1;
 
 static const uint16_t BATTERY_SERVICE_UUID = 0x180F;
 static const uint16_t BATTERY_CHAR_UUID    = 0x2A19;
 
+// Objek UUID dibuat sekali, bukan tiap advert / discovery
+static const NimBLEUUID ITAG_SERVICE(ITAG_SERVICE_UUID);
+static const NimBLEUUID ITAG_CHAR(ITAG_CHAR_UUID);
+static const NimBLEUUID BATTERY_SERVICE(BATTERY_SERVICE_UUID);
+static const NimBLEUUID BATTERY_CHAR(BATTERY_CHAR_UUID);
+
 // MFG prefix anti-spoof
 static const uint8_t ITAG_MFG_PREFIX[] = {
     0x05, 0x01, 0xF4, 0xA9, 0x05, 0x54, 0x53, 0x48
@@ -117,6 +206,23 @@ static const uint8_t ITAG_MFG_PREFIX[] = {
 static const size_t ITAG_MFG_PREFIX_LEN =
     sizeof(ITAG_MFG_PREFIX) / sizeof(ITAG_MFG_PREFIX[0]);
 
+// Key yang boleh unlock. Tambah baris untuk fob cadangan / rider kedua.
+struct AuthorizedKey {
+    const char*    mac;
+    const uint8_t* mfgPrefix;      // nullptr = tanpa cek MFG
+    size_t         mfgPrefixLen;
+};
+
+static const AuthorizedKey AUTHORIZED_KEYS[] = {
+    { "f4:a9:05:54:53:48", ITAG_MFG_PREFIX, ITAG_MFG_PREFIX_LEN },
+    // { "xx:xx:xx:xx:xx:xx", SPARE_MFG_PREFIX, sizeof(SPARE_MFG_PREFIX) },
+};
+static const uint8_t KEY_COUNT =
+    sizeof(AUTHORIZED_KEYS) / sizeof(AUTHORIZED_KEYS[0]);
+
+// Alamat mentah tiap key (diisi di setup) supaya match advert cukup memcmp
+uint8_t keyAddrVal[KEY_COUNT][6];
+
 // ======================================================================
 //  PIN ESP32-C3 SUPER MINI
 // ======================================================================
@@ -129,23 +235,35 @@ static const size_t ITAG_MFG_PREFIX_LEN =
 // ======================================================================
 //  JARAK (RSSI) & CONTACT
 // ======================================================================
+// Default sebelum kalibrasi; threshold aktif per key ada di rssiCalib
 #define RSSI_NEAR_THRESHOLD -71
 #define RSSI_FAR_THRESHOLD  -72
 
-float         rssiAvg         = -100.0f;
-unsigned long lastRssiUpdate  = 0;
-
-bool    bleConnected   = false;
+// Global ini = state key TERDEKAT (lihat selectNearestKey), state per
+// koneksi ada di Session.
+float   rssiAvg        = -100.0f;
+bool    bleConnected   = false;   // minimal satu sesi connect
 bool    isNear         = false;
-uint8_t nearFalseCount = 0;
 
 bool          contactActive      = false;
-unsigned long contactOnStartMs   = 0;
 const unsigned long CONTACT_AUTO_ON_MS   = 3UL * 1000UL;
 const unsigned long CONTACT_MANUAL_ON_MS = 7UL * 1000UL;
-unsigned long       contactDurationMs    = CONTACT_AUTO_ON_MS;
 bool                sessionHadContact    = false;
 
+// ======================================================================
+//  KALIBRASI RSSI (per key, disimpan di NVS)
+// ======================================================================
+RssiCalib    rssiCalib;
+portMUX_TYPE calibMux = portMUX_INITIALIZER_UNLOCKED;   // noteFar dari task NimBLE
+Preferences  calibPrefs;
+unsigned long lastCalibSaveMs = 0;
+const unsigned long CALIB_SAVE_MIN_MS      = 10UL * 60UL * 1000UL;   // jaga umur flash
+const unsigned long CALIB_UNLOCK_DEDUP_MS  = 2000;   // klik beruntun = satu sampel
+const uint8_t       CALIB_MIN_RSSI_SAMPLES = 10;     // EMA dari -100 butuh ~10 detik
+const unsigned long CALIB_IDLE_FAR_MS      = 10UL * 60UL * 1000UL;   // sampel far "parkir"
+unsigned long lastCalibUnlockMs[RSSI_CALIB_MAX_KEYS] = {};
+volatile unsigned long lastCalibActivityMs = 0;   // trigger / klik iTAG terakhir
+
 // ======================================================================
 //  ADAPTIVE SCAN STATE
 // ======================================================================
@@ -154,19 +272,135 @@ enum ScanMode {
     SCAN_MODE_SLOW
 };
 
+const uint16_t SCAN_AGGR_INTERVAL_MS = 45;
+const uint16_t SCAN_AGGR_WINDOW_MS   = 45;
+const uint16_t SCAN_SLOW_INTERVAL_MS = 320;
+const uint16_t SCAN_SLOW_WINDOW_MS   = 40;
+
 ScanMode      currentScanMode           = SCAN_MODE_AGGRESSIVE;
-// Timer untuk patokan kapan kita terakhir kali start AGGRESSIVE scan.
-// Dipakai buat hitung 30 detik ke SLOW.
-unsigned long lastAggressiveScanStartMs = 0;
+// 30 detik di AGGRESSIVE tanpa connect → SLOW (TIMER_SCAN_SLOW)
+const unsigned long SCAN_AGGRESSIVE_HOLD_MS = 30000;
 
 // ======================================================================
 //  BATTERY STATE
 // ======================================================================
 int  batteryPercent      = -1;
 bool batteryLow          = false;
-unsigned long lastBattPollMs = 0;
 const unsigned long BATTERY_POLL_MS = 60000;
 
+// ======================================================================
+//  ENERGY PROFILER
+// ======================================================================
+#if defined(CONFIG_IDF_TARGET_ESP32C3)
+  #define ENERGY_BOARD ENERGY_BOARD_ESP32C3_SUPERMINI
+#else
+  #define ENERGY_BOARD ENERGY_BOARD_ESP32_DEVKIT
+#endif
+
+EnergyProfiler energy;
+portMUX_TYPE   energyMux = portMUX_INITIALIZER_UNLOCKED;  // loop vs task NimBLE
+unsigned long  lastEnergyReportMs = 0;
+const unsigned long ENERGY_REPORT_MS = 60000;
+
+// ======================================================================
+//  TELEMETRY GATT
+//  Counter selalu jalan (murah); server + notify hanya kalau TelemetryGatt.
+// ======================================================================
+TelemetryCounters telemetryCounters = {};
+
+#ifdef TelemetryGatt
+const uint16_t TELEMETRY_STATUS_MIN_MS   = 200;    // batas laju notify status
+const uint16_t TELEMETRY_COUNTERS_MIN_MS = 1000;
+const uint16_t TELEMETRY_HEARTBEAT_MS    = 5000;
+const uint16_t TELEMETRY_ADV_MIN_UNITS   = 1600;   // × 0.625 ms = 1 s, cukup untuk servis
+const uint16_t TELEMETRY_ADV_MAX_UNITS   = 2400;
+// Passkey statis (ditampilkan "display only"): HP servis harus pairing +
+// bonding dulu, baru characteristic boleh dibaca / notify dikirim. Tidak
+// ada default di source: per motor lewat build flag -D TELEMETRY_PASSKEY
+// (platformio.ini ambil dari environment). Kosong, angka contoh lama, atau
+// bukan 6 digit → build gagal.
+#ifndef TELEMETRY_PASSKEY
+#error "TelemetryGatt butuh -D TELEMETRY_PASSKEY=<6 digit> per motor"
+#endif
+static_assert((TELEMETRY_PASSKEY + 0) >= 100000 && (TELEMETRY_PASSKEY + 0) <= 999999,
+              "TELEMETRY_PASSKEY harus 6 digit (100000..999999), set per motor");
+static_assert((TELEMETRY_PASSKEY + 0) != 246810 && (TELEMETRY_PASSKEY + 0) != 123456,
+              "TELEMETRY_PASSKEY masih angka contoh, ganti per motor");
+
+NimBLECharacteristic* telemetryStatusChar   = nullptr;
+NimBLECharacteristic* telemetryCountersChar = nullptr;
+TelemetryCoalescer    telemetryStatusCo;
+TelemetryCoalescer    telemetryCountersCo;
+
+// CCCD NimBLE bisa ditulis tanpa security, jadi subscribe saja bukan bukti
+// pairing. Notify cuma dikirim ke conn handle yang subscribe di link
+// terenkripsi + terautentikasi (dicek di onSubscribe).
+const uint8_t TELEMETRY_MAX_SUBSCRIBERS = 2;
+struct TelemetrySubscribers {
+    uint16_t conn[TELEMETRY_MAX_SUBSCRIBERS];
+    uint8_t  count;
+};
+TelemetrySubscribers telemetryStatusSubs   = {};
+TelemetrySubscribers telemetryCountersSubs = {};
+portMUX_TYPE         telemetryMux = portMUX_INITIALIZER_UNLOCKED;   // loop vs task NimBLE
+#endif
+
+#ifdef ALLOC_COUNTER
+unsigned long  lastAllocReportMs = 0;
+const unsigned long ALLOC_REPORT_MS = 10000;
+#endif
+
+// ======================================================================
+//  BOOT TIMING & FAST RECONNECT
+// ======================================================================
+BootTiming                   bootTiming = {};
+RTC_NOINIT_ATTR BootRtcCache bootCache;          // selamat dari ESP.restart()/brownout
+bool                         bootReportDone       = false;
+bool                         fastReconnectPending = false;
+const uint32_t      FAST_RECONNECT_TIMEOUT_MS = 1500;   // gagal → lanjut scan biasa
+const uint32_t      CONNECT_TIMEOUT_MS        = 30000;  // default NimBLE
+const unsigned long BOOT_REPORT_MAX_MS        = 60000;  // lapor walau belum unlock
+
+// esp_timer: µs sejak app start, tanpa ROM + bootloader (lihat BootTiming.h)
+inline void bootMark(BootPhase p) {
+    bootTiming.mark(p, (uint32_t)esp_timer_get_time());
+}
+
+// ======================================================================
+//  DEADLINE: semua timeout protokol lewat satu esp_timer one-shot
+// ======================================================================
+enum TimerId : uint8_t {
+    TIMER_CONTACT_OFF = 0,     // + callback: relay OFF langsung di konteks timer
+    TIMER_DIGIT_WINDOW,
+    TIMER_ACTIVATION_WINDOW,
+    TIMER_CLICK_WINDOW,
+    TIMER_REBOOT_WINDOW,
+    TIMER_SCAN_SLOW,
+    TIMER_BATTERY_POLL,
+    TIMER_RELAY_HOLD,          // + ENERGY_RELAY_COUNT slot: pull-in → hold (RelayDriver)
+    TIMER_RELAY_HOLD_LAST = TIMER_RELAY_HOLD + ENERGY_RELAY_COUNT - 1
+};
+static_assert(TIMER_RELAY_HOLD_LAST < DEADLINE_MAX_TIMERS, "slot deadline habis");
+
+DeadlineWheel    deadlines;
+EspDeadlineClock deadlineClock;
+
+// ======================================================================
+//  RELAY COIL ECONOMIZER
+//  Index driver = EnergyRelay. Hold duty default (RELAY_PROFILES di
+//  lib/RelayDriver) konservatif; turunkan setelah cek must-hold relay
+//  yang dipakai (relay harus tetap nempel waktu motor getar + aki drop
+//  saat starter).
+// ======================================================================
+static_assert(ENERGY_RELAY_COUNT <= RELAY_DRIVER_MAX, "tambah RELAY_DRIVER_MAX");
+
+const uint8_t RELAY_PINS[ENERGY_RELAY_COUNT] = { CONTACT_RELAY, SEIN_RELAY, HORN_RELAY };
+
+LedcRelayOutput relayOutput;
+RelayDriver     relays;
+
+inline uint64_t msToUs(unsigned long ms) { return (uint64_t)ms * 1000ULL; }
+
 // ======================================================================
 //  TOMBOL TRIGGER FISIK
 // ======================================================================
@@ -179,16 +413,12 @@ const unsigned long DEBOUNCE_MS = 30;
 //  5x TRIGGER RESTART ESP
 // ======================================================================
 uint8_t       rebootTriggerCount   = 0;
-unsigned long rebootWindowStartMs  = 0;
 const unsigned long REBOOT_WINDOW_MS      = 5000;
 const uint8_t       REBOOT_TRIGGER_TARGET = 5;
 
 // ======================================================================
 //  KLIK ITAG → SINGLE / MULTI
 // ======================================================================
-volatile uint8_t  clickCount       = 0;
-volatile unsigned long lastClickMs = 0;
-unsigned long lastBtnDedupMs       = 0;
 const unsigned long BTN_DEBOUNCE_MS  = 150;
 const unsigned long CLICK_WINDOW_MS  = 400;
 
@@ -202,7 +432,6 @@ enum ManualState {
 ManualState manualState = MANUAL_IDLE;
 
 uint8_t       activationCount    = 0;
-unsigned long activationStartMs  = 0;
 const unsigned long ACTIVATION_WINDOW_MS = 5000;
 bool manual_mode = false;
 
@@ -211,18 +440,79 @@ const uint8_t CODE_PATTERN[CODE_LEN] = {2, 3, 1, 0};
 
 uint8_t       manualIndex     = 0;
 uint8_t       digitPressCount = 0;
-unsigned long digitStartMs    = 0;
 const unsigned long DIGIT_WINDOW_MS = 5000;
 
 // ======================================================================
-//  KARAKTERISTIK BLE
+//  SESI PER KONEKSI (beberapa key sekaligus)
 // ======================================================================
-NimBLERemoteCharacteristic* gButtonChar = nullptr;
-NimBLERemoteCharacteristic* gBattChar   = nullptr;
+#define MAX_SESSIONS 3
+static_assert(KEY_COUNT <= RSSI_CALIB_MAX_KEYS, "tambah RSSI_CALIB_MAX_KEYS");
+static_assert(MAX_SESSIONS <= CONFIG_BT_NIMBLE_MAX_CONNECTIONS,
+              "naikkan CONFIG_BT_NIMBLE_MAX_CONNECTIONS di platformio.ini");
+#ifdef TelemetryGatt
+static_assert(MAX_SESSIONS + 1 <= CONFIG_BT_NIMBLE_MAX_CONNECTIONS,
+              "TelemetryGatt butuh satu koneksi lagi untuk HP servis");
+#endif
+
+// Pembagian tulis (lihat sessionMux):
+//   task NimBLE : used, gen, connHandle, keyIndex, client (buka/tutup slot),
+//                 batteryPercent, batteryLow, lastBtnDedupMs, clickCount
+//   loop()      : sisanya, lewat sessionSnapshot() → sessionCommit()
+struct Session {
+    bool                        used;
+    uint16_t                    gen;          // beda tiap buka slot
+    uint16_t                    connHandle;
+    int8_t                      keyIndex;
+    NimBLEClient*               client;
+    NimBLERemoteCharacteristic* buttonChar;
+    NimBLERemoteCharacteristic* battChar;
+    uint16_t                    battHandle;   // untuk GATT read mentah
+    float                       rssiAvg;
+    bool                        isNear;
+    uint8_t                     nearFalseCount;
+    uint8_t                     rssiSamples;     // saturasi di 255
+    unsigned long               lastRssiUpdate;
+    const char*                 lastZone;
+    int                         batteryPercent;
+    bool                        batteryLow;
+    unsigned long               lastBtnDedupMs;
+    unsigned long               lastIdleFarMs;   // sampel far parkir terakhir
+    bool                        discoveryTried;  // discoverServices() sekali per koneksi
+    uint8_t                     clickCount;      // klik dalam CLICK_WINDOW_MS
+};
+
+Session sessions[MAX_SESSIONS];
+uint8_t sessionCount   = 0;
+uint16_t sessionGen    = 0;
+int8_t  nearestSession = -1;
+int8_t  nearestKey     = -1;      // keyIndex sesi terdekat (untuk telemetry)
+// Slot sessions[] + notifyRoutes dibuka/ditutup dari task NimBLE sementara
+// loop() mengiterasinya. Callback NimBLE sendiri jalan serial di satu task;
+// yang perlu dijaga cuma loop() vs task NimBLE. Jangan I/O di dalamnya.
+portMUX_TYPE sessionMux = portMUX_INITIALIZER_UNLOCKED;
+bool    connectPending = false;   // NimBLE cuma bisa satu connect async sekaligus
+
+// Routing notify (lib/NotifyRoutes): tombol + baterai per sesi
+static_assert(MAX_SESSIONS * 2 <= NOTIFY_ROUTE_CAPACITY, "tambah NOTIFY_ROUTE_CAPACITY");
+NotifyRouteTable notifyRoutes;
+
+// Naik tiap event koneksi / ganti mode scan; window tanpa event = steady state
+volatile uint32_t bleEventSeq = 0;
+// Window ini ada kerja non-BLE yang boleh alokasi (tulis NVS); di-clear
+// reportAllocations(). Jangan pakai bleEventSeq untuk ini.
+volatile bool     allocWindowDirty = false;
 
 // ======================================================================
-//  PWM / DIMMING INDICATOR_LED (analogWrite style)
+//  PWM / DIMMING INDICATOR_LED
+//  Channel LEDC sendiri dengan timer sendiri (bukan analogWrite): di
+//  Arduino-ESP32 3.x analogWrite ambil channel bebas pertama = channel 3,
+//  satu timer dengan relay HORN (channel 2), lalu timer itu dipaksa ke
+//  1 kHz / 8 bit dan PWM hold relay 20 kHz rusak.
 // ======================================================================
+#define INDICATOR_LEDC_CH   RELAY_LEDC_FREE_CHANNEL(ENERGY_RELAY_COUNT)
+const uint32_t INDICATOR_PWM_HZ   = 1000;
+const uint8_t  INDICATOR_PWM_BITS = 8;
+
 uint8_t       indicatorLevel         = 0;
 bool          indicatorDimmingActive = false;
 bool          indicatorDimmingUp     = true;
@@ -236,7 +526,21 @@ unsigned long lastBattBlinkMs = 0;
 bool          battBlinkState  = false;
 
 inline void indicatorSet(uint8_t level) {
-    analogWrite(INDICATOR_LED, 255 - level); // aktif LOW
+#if defined(ESP_ARDUINO_VERSION_MAJOR) && ESP_ARDUINO_VERSION_MAJOR >= 3
+    ledcWrite(INDICATOR_LED, 255 - level);       // aktif LOW
+#else
+    ledcWrite(INDICATOR_LEDC_CH, 255 - level);   // aktif LOW
+#endif
+}
+
+void indicatorBegin() {
+#if defined(ESP_ARDUINO_VERSION_MAJOR) && ESP_ARDUINO_VERSION_MAJOR >= 3
+    ledcAttachChannel(INDICATOR_LED, INDICATOR_PWM_HZ, INDICATOR_PWM_BITS, INDICATOR_LEDC_CH);
+#else
+    ledcSetup(INDICATOR_LEDC_CH, INDICATOR_PWM_HZ, INDICATOR_PWM_BITS);
+    ledcAttachPin(INDICATOR_LED, INDICATOR_LEDC_CH);
+#endif
+    indicatorSet(0);
 }
 
 // ======================================================================
@@ -259,9 +563,414 @@ void ledBlink(uint8_t times, int onMs, int offMs) {
     }
 }
 
+void energyRadio(EnergyRadioState s, float scanDuty = 0.0f) {
+    unsigned long nowMs = millis();
+    portENTER_CRITICAL(&energyMux);
+    energy.setRadioState(nowMs, s, scanDuty);
+    portEXIT_CRITICAL(&energyMux);
+}
+
+#ifdef TelemetryGatt
+void energyAdvertising(bool on) {
+    // interval rata-rata min..max, satuan 0.625 ms
+    const uint16_t intervalMs =
+        (uint16_t)((TELEMETRY_ADV_MIN_UNITS + TELEMETRY_ADV_MAX_UNITS) * 5 / 16);
+    unsigned long nowMs = millis();
+    portENTER_CRITICAL(&energyMux);
+    energy.setAdvertising(nowMs, on, energyAdvDuty(intervalMs));
+    portEXIT_CRITICAL(&energyMux);
+}
+#endif
+
+// Tiap level drive relay berubah (juga pull-in → hold di konteks timer):
+// bobot d² masuk profiler.
+void onRelayDrive(uint8_t relay, float weight, void* arg) {
+    unsigned long nowMs = millis();
+    portENTER_CRITICAL(&energyMux);
+    energy.setRelay(nowMs, (EnergyRelay)relay, weight > 0.0f, weight);
+    portEXIT_CRITICAL(&energyMux);
+}
+
+// Semua tulis relay lewat sini (pull-in/hold + accounting di RelayDriver).
+void relayWrite(EnergyRelay r, bool on) {
+    if (on) {
+        relays.on(r);
+    } else {
+        relays.off(r);
+    }
+}
+
+// Konteks esp_timer: cuma matikan coil tepat di deadline,
+// state diurus loop() lewat event TIMER_CONTACT_OFF.
+void onContactDeadline(uint8_t id, void* arg) {
+    relays.off(ENERGY_RELAY_CONTACT);
+}
+
+// Hemat energi coil sejak boot; ikut laporan energi berkala.
+void reportRelaySavings() {
+    float savedMah = 0.0f;
+    float fullMah  = 0.0f;
+
+    for (uint8_t r = 0; r < ENERGY_RELAY_COUNT; ++r) {
+        RelayStats st;
+        relays.stats(r, st);
+        float maPerUs = ENERGY_BOARD.relayCoilMa[r] / 3.6e9f;   // mA·µs → mAh
+        fullMah  += maPerUs * (float)st.onUs;
+        savedMah += maPerUs * (float)(st.onUs - st.driveUs);
+    }
+
+    if (fullMah <= 0.0f) return;
+    // Print::printf malloc kalau hasil > 64 byte → dipecah
+    Serial.printf("[RELAY] sejak boot: coil %.3f mAh,", fullMah - savedMah);
+    Serial.printf(" hemat %.3f mAh (%.0f%%)\n", savedMah, 100.0f * savedMah / fullMah);
+}
+
+void contactOn(unsigned long durationMs) {
+    telemetryCounters.unlocks++;
+    contactActive     = true;
+    sessionHadContact = true;
+    deadlines.scheduleIn(TIMER_CONTACT_OFF, msToUs(durationMs));
+    relayWrite(ENERGY_RELAY_CONTACT, true);
+    bootMark(BOOT_UNLOCK);
+}
+
+void contactOff() {
+    deadlines.cancel(TIMER_CONTACT_OFF);
+    contactActive = false;
+    relayWrite(ENERGY_RELAY_CONTACT, false);
+}
+
+int8_t findKey(const NimBLEAddress& addr) {
+    const uint8_t* val = addr.getVal();
+    for (uint8_t k = 0; k < KEY_COUNT; ++k) {
+        if (memcmp(val, keyAddrVal[k], 6) == 0) return (int8_t)k;
+    }
+    return -1;
+}
+
+bool keyHasSession(int8_t key) {
+    for (uint8_t i = 0; i < MAX_SESSIONS; ++i) {
+        if (sessions[i].used && sessions[i].keyIndex == key) return true;
+    }
+    return false;
+}
+
+Session* sessionByClient(const NimBLEClient* client) {
+    for (uint8_t i = 0; i < MAX_SESSIONS; ++i) {
+        if (sessions[i].used && sessions[i].client == client) return &sessions[i];
+    }
+    return nullptr;
+}
+
+// Slot awal = conn handle, probe linear kalau bentrok. Task NimBLE.
+Session* sessionOpen(NimBLEClient* client, int8_t key) {
+    uint16_t handle = client->getConnHandle();
+    unsigned long nowMs = millis();
+    Session* opened = nullptr;
+
+    portENTER_CRITICAL(&sessionMux);
+    for (uint8_t probe = 0; probe < MAX_SESSIONS; ++probe) {
+        Session& ses = sessions[(handle + probe) % MAX_SESSIONS];
+        if (ses.used) continue;
+
+        ses = Session{};
+        ses.used           = true;
+        ses.gen            = ++sessionGen;
+        ses.connHandle     = handle;
+        ses.keyIndex       = key;
+        ses.client         = client;
+        ses.rssiAvg        = -100.0f;
+        ses.batteryPercent = -1;
+        ses.lastIdleFarMs  = nowMs;
+        sessionCount++;
+        opened = &ses;
+        break;
+    }
+    portEXIT_CRITICAL(&sessionMux);
+    return opened;
+}
+
+// Task NimBLE.
+void sessionClose(Session* ses) {
+    portENTER_CRITICAL(&sessionMux);
+    notifyRoutes.removeSession((uint8_t)(ses - sessions));
+    ses->used = false;
+    sessionCount--;
+    portEXIT_CRITICAL(&sessionMux);
+}
+
+// Salinan slot i untuk dipakai loop() tanpa lock. false kalau slot kosong.
+bool sessionSnapshot(uint8_t i, Session& out) {
+    portENTER_CRITICAL(&sessionMux);
+    out = sessions[i];
+    portEXIT_CRITICAL(&sessionMux);
+    return out.used;
+}
+
+// Tulis balik field milik loop() kalau slot masih koneksi yang sama.
+bool sessionCommit(uint8_t i, const Session& local) {
+    portENTER_CRITICAL(&sessionMux);
+    Session& ses = sessions[i];
+    bool same = ses.used && ses.gen == local.gen;
+    if (same) {
+        ses.buttonChar     = local.buttonChar;
+        ses.battChar       = local.battChar;
+        ses.battHandle     = local.battHandle;
+        ses.rssiAvg        = local.rssiAvg;
+        ses.isNear         = local.isNear;
+        ses.nearFalseCount = local.nearFalseCount;
+        ses.rssiSamples    = local.rssiSamples;
+        ses.lastRssiUpdate = local.lastRssiUpdate;
+        ses.lastZone       = local.lastZone;
+        ses.lastIdleFarMs  = local.lastIdleFarMs;
+        ses.discoveryTried = local.discoveryTried;
+    }
+    portEXIT_CRITICAL(&sessionMux);
+    return same;
+}
+
+// Dari loop() (discoverServices): route cuma masuk kalau sesi belum ditutup.
+void routeAdd(uint8_t session, const Session& local, uint16_t attrHandle, NotifyKind kind) {
+    portENTER_CRITICAL(&sessionMux);
+    bool alive = sessions[session].used && sessions[session].gen == local.gen;
+    bool ok    = !alive || notifyRoutes.add(local.connHandle, attrHandle, session, kind);
+    uint8_t n  = notifyRoutes.count();
+    portEXIT_CRITICAL(&sessionMux);
+
+    if (!ok) {
+        Serial.printf("!! Tabel route notify penuh (%u), key #%d tidak dapat notify\n",
+                      n, local.keyIndex);
+    }
+}
+
+// ======================================================================
+//  KALIBRASI RSSI
+// ======================================================================
+#ifdef LogRssiTrace
+  // ms,key,rssi,truth,event — truth '?' diisi manual waktu ambil data
+  #define TRACE_RSSI(ms, key, rssi, ev) \
+      Serial.printf("[TRACE] %lu,%d,%.1f,?,%c\n", (unsigned long)(ms), (key), (rssi), (ev))
+#else
+  #define TRACE_RSSI(ms, key, rssi, ev)
+#endif
+
+void calibPrint(int8_t key) {
+    portENTER_CRITICAL(&calibMux);
+    RssiThresholds th = rssiCalib.thresholds(key);
+    uint16_t nNear    = rssiCalib.nearHist(key).total;
+    uint16_t nFar     = rssiCalib.farHist(key).total;
+    portEXIT_CRITICAL(&calibMux);
+
+    Serial.printf("[CALIB] key #%d near>=%d far<=%d (%u unlock, %u far)%s\n",
+                  key, th.nearDbm, th.farDbm, nNear, nFar,
+                  th.calibrated ? "" : " default");
+}
+
+RssiThresholds calibThresholds(int8_t key) {
+    portENTER_CRITICAL(&calibMux);
+    RssiThresholds th = rssiCalib.thresholds(key);
+    portEXIT_CRITICAL(&calibMux);
+    return th;
+}
+
+// Trigger ditekan saat connect. Trigger bisa ditekan siapa saja, jadi
+// RSSI sekarang baru jadi sampel "near" kalau tekan ini unlock, atau kalau
+// key yang sama diklik dalam RSSI_CALIB_CONFIRM_MS (calibNoteClick).
+void calibNotePress(const Session& ses, unsigned long nowMs, bool unlocked) {
+    if (ses.keyIndex < 0 || ses.rssiSamples < CALIB_MIN_RSSI_SAMPLES) return;
+    if (nowMs - lastCalibUnlockMs[ses.keyIndex] < CALIB_UNLOCK_DEDUP_MS) return;
+    lastCalibUnlockMs[ses.keyIndex] = nowMs;
+
+    TRACE_RSSI(nowMs, ses.keyIndex, ses.rssiAvg, unlocked ? 'U' : 'P');
+    portENTER_CRITICAL(&calibMux);
+    bool noted = rssiCalib.notePress(ses.keyIndex, nowMs, ses.rssiAvg, unlocked);
+    portEXIT_CRITICAL(&calibMux);
+    if (noted) calibPrint(ses.keyIndex);
+}
+
+// Klik iTAG = bukti pegang key; konfirmasi trigger yang masih ditahan
+void calibNoteClick(const Session& ses, unsigned long nowMs) {
+    if (ses.keyIndex < 0) return;
+
+    TRACE_RSSI(nowMs, ses.keyIndex, ses.rssiAvg, 'K');
+    portENTER_CRITICAL(&calibMux);
+    bool noted = rssiCalib.noteClick(ses.keyIndex, nowMs);
+    portEXIT_CRITICAL(&calibMux);
+    if (noted) calibPrint(ses.keyIndex);
+}
+
+// Sampel far bukan dari tepi jangkauan: key connect tapi sudah di zona far,
+// tanpa trigger/klik/kontak selama CALIB_IDLE_FAR_MS (motor diparkir).
+void calibNoteIdleFar(Session& ses, unsigned long nowMs, int8_t farDbm) {
+    if (ses.keyIndex < 0 || ses.rssiSamples < CALIB_MIN_RSSI_SAMPLES) return;
+    if (ses.isNear || contactActive || ses.rssiAvg > farDbm) return;
+    if (nowMs - lastCalibActivityMs < CALIB_IDLE_FAR_MS) return;
+    if (nowMs - ses.lastIdleFarMs < CALIB_IDLE_FAR_MS) return;
+    ses.lastIdleFarMs = nowMs;
+
+    TRACE_RSSI(nowMs, ses.keyIndex, ses.rssiAvg, 'I');
+    portENTER_CRITICAL(&calibMux);
+    rssiCalib.noteFar(ses.keyIndex, ses.rssiAvg);
+    portEXIT_CRITICAL(&calibMux);
+    calibPrint(ses.keyIndex);
+}
+
+void calibNoteFar(const Session& ses) {
+    if (ses.keyIndex < 0 || ses.rssiSamples < CALIB_MIN_RSSI_SAMPLES) return;
+
+    TRACE_RSSI(millis(), ses.keyIndex, ses.rssiAvg, 'F');
+    portENTER_CRITICAL(&calibMux);
+    rssiCalib.noteFar(ses.keyIndex, ses.rssiAvg);
+    portEXIT_CRITICAL(&calibMux);
+    calibPrint(ses.keyIndex);
+}
+
+void loadCalibration() {
+    if (!calibPrefs.begin("rssicalib", true)) return;   // belum pernah disimpan
+
+    for (uint8_t k = 0; k < KEY_COUNT; ++k) {
+        char name[4] = { 'k', (char)('0' + k), '\0' };
+        RssiCalibRecord rec;
+        if (calibPrefs.getBytes(name, &rec, sizeof(rec)) != sizeof(rec) || rec.keyIndex != k) {
+            continue;
+        }
+
+        portENTER_CRITICAL(&calibMux);
+        bool ok = rssiCalib.restore(rec);
+        portEXIT_CRITICAL(&calibMux);
+        if (ok) calibPrint(k);
+    }
+    calibPrefs.end();
+}
+
+// Tulis NVS maksimal sekali per CALIB_SAVE_MIN_MS, hanya key yang berubah.
+void saveCalibration(unsigned long nowMs) {
+    if (nowMs - lastCalibSaveMs < CALIB_SAVE_MIN_MS) return;
+
+    bool any = false;
+    for (uint8_t k = 0; k < KEY_COUNT; ++k) any |= rssiCalib.dirty(k);
+    if (!any) return;
+    lastCalibSaveMs = nowMs;
+
+    allocWindowDirty = true;   // Preferences/NVS alokasi sendiri
+    if (!calibPrefs.begin("rssicalib", false)) return;
+
+    for (uint8_t k = 0; k < KEY_COUNT; ++k) {
+        if (!rssiCalib.dirty(k)) continue;
+
+        RssiCalibRecord rec;
+        portENTER_CRITICAL(&calibMux);
+        rssiCalib.record(k, rec);
+        portEXIT_CRITICAL(&calibMux);
+
+        char name[4] = { 'k', (char)('0' + k), '\0' };
+        calibPrefs.putBytes(name, &rec, sizeof(rec));
+    }
+    calibPrefs.end();
+    allocWindowDirty = true;
+    DBGLN("[CALIB] disimpan ke NVS");
+}
+
+void reportEnergy(unsigned long nowMs) {
+    EnergyTotals t;
+    portENTER_CRITICAL(&energyMux);
+    energy.snapshot(nowMs, t);
+    portEXIT_CRITICAL(&energyMux);
+
+    if (t.totalMs == 0) return;
+
+    float logicMah, relayMah;
+    energySplitMahPerDay(t, ENERGY_BOARD, &logicMah, &relayMah);
+
+    // Print::printf malloc kalau hasil > 64 byte → dipecah
+    Serial.printf("[ENERGY] %s: %.1f mAh/hari", ENERGY_BOARD.name, logicMah + relayMah);
+    Serial.printf(" (logic %.1f + relay %.1f) |", logicMah, relayMah);
+    for (uint8_t s = 0; s < ENERGY_RADIO_STATE_COUNT; ++s) {
+        Serial.printf(" %s %.1f%%", energyStateName((EnergyRadioState)s),
+                      100.0f * (float)t.stateMs[s] / (float)t.totalMs);
+    }
+    if (t.advMs) Serial.printf(" | ADV %.1f%%", 100.0f * (float)t.advMs / (float)t.totalMs);
+    Serial.printf(" | contact %lus\n", (unsigned long)(t.relayMs[ENERGY_RELAY_CONTACT] / 1000));
+    reportRelaySavings();
+}
+
+const char* resetReasonName(esp_reset_reason_t r) {
+    switch (r) {
+        case ESP_RST_POWERON:  return "POWERON";
+        case ESP_RST_SW:       return "SW";
+        case ESP_RST_BROWNOUT: return "BROWNOUT";
+        case ESP_RST_PANIC:    return "PANIC";
+        case ESP_RST_INT_WDT:
+        case ESP_RST_TASK_WDT:
+        case ESP_RST_WDT:      return "WDT";
+        default:               return "OTHER";
+    }
+}
+
+void reportBootTiming() {
+    bootReportDone = true;
+
+    Serial.print("[BOOT] fase (ms sejak app start, tanpa bootloader):");
+    for (uint8_t p = 0; p < BOOT_PHASE_COUNT; ++p) {
+        if (!bootTiming.has((BootPhase)p)) continue;
+        Serial.printf(" %s=%.1f", bootPhaseName((BootPhase)p), bootTiming.appUs[p] / 1000.0f);
+    }
+    Serial.println();
+
+    uint32_t toScan   = bootTiming.appUs[BOOT_SCAN_START];
+    uint32_t toUnlock = bootTiming.appUs[BOOT_UNLOCK];
+    if (bootTiming.has(BOOT_FAST_RECONNECT) && !bootTiming.has(BOOT_SCAN_START)) {
+        toScan = bootTiming.appUs[BOOT_FAST_RECONNECT];   // radio langsung connect, tanpa scan
+    }
+
+    Serial.printf("[BOOT] app->scan %.1f ms, app->unlock %s%.1f ms | boot sebelumnya: %.1f / %.1f ms\n",
+                  toScan / 1000.0f,
+                  toUnlock ? "" : "(belum) ",
+                  toUnlock / 1000.0f,
+                  bootCache.lastAppToScanUs / 1000.0f,
+                  bootCache.lastAppToUnlockUs / 1000.0f);
+
+    bootCache.lastAppToScanUs   = toScan;
+    bootCache.lastAppToUnlockUs = toUnlock;
+    bootCacheSeal(bootCache);
+}
+
+void rememberKey(const NimBLEAddress& addr) {
+    memcpy(bootCache.keyAddr, addr.getVal(), sizeof(bootCache.keyAddr));
+    bootCache.keyAddrType = addr.getType();
+    bootCache.keyValid    = 1;
+    bootCacheSeal(bootCache);
+}
+
+// Setelah reset non-power-on, coba connect langsung ke key terakhir.
+// Return false kalau tidak ada cache yang bisa dipakai → caller scan biasa.
+bool startFastReconnect(NimBLEClientCallbacks* callbacks) {
+    if (!bootCache.keyValid) return false;
+
+    NimBLEAddress addr(bootCache.keyAddr, bootCache.keyAddrType);
+    if (findKey(addr) < 0) return false;   // cuma key yang sah
+
+    NimBLEClient* client = NimBLEDevice::createClient(addr);
+    if (!client) return false;
+
+    client->setClientCallbacks(callbacks, false);
+    client->setConnectTimeout(FAST_RECONNECT_TIMEOUT_MS);
+    if (!client->connect(true, true, false)) {
+        NimBLEDevice::deleteClient(client);
+        return false;
+    }
+
+    fastReconnectPending = true;
+    connectPending       = true;
+    energyRadio(ENERGY_IDLE);
+    bootMark(BOOT_FAST_RECONNECT);
+    return true;
+}
+
 // Forward declaration
 void configureScanAggressive(unsigned long nowMs);
 void configureScanSlow();
+void rescanAfterLinkLoss();
 
 // ======================================================================
 //  NOTIFY CALLBACK
@@ -273,23 +982,27 @@ void notifyCallback(NimBLERemoteCharacteristic* chr,
 {
     if (len == 0) return;
 
-    NimBLEUUID chrId = chr->getUUID();
+    uint16_t connHandle = chr->getRemoteService()->getClient()->getConnHandle();
+    portENTER_CRITICAL(&sessionMux);
+    const NotifyRoute* route = notifyRoutes.find(connHandle, chr->getHandle());
+    NotifyRoute found = route ? *route : NotifyRoute{};
+    portEXIT_CRITICAL(&sessionMux);
+    if (!route) return;
+
+    Session* ses = &sessions[found.session];
 
-    if (chrId.equals(NimBLEUUID(BATTERY_CHAR_UUID))) {
+    if (found.kind == NOTIFY_BATTERY) {
         uint8_t level = data[0];
-        batteryPercent = level;
-        batteryLow     = (level < 20);
+        ses->batteryPercent = level;
+        ses->batteryLow     = (level < 20);
 
 #ifdef ReadMessage
-        Serial.printf("[BATT-NOTIFY] level=%u%%  low=%d\n", level, batteryLow);
+        Serial.printf("[BATT-NOTIFY] key #%d level=%u%%  low=%d\n",
+                      ses->keyIndex, level, ses->batteryLow);
 #endif
         return;
     }
 
-    if (!chrId.equals(NimBLEUUID(ITAG_CHAR_UUID))) {
-        return;
-    }
-
     uint8_t val       = data[0];
     unsigned long now = millis();
 
@@ -306,13 +1019,18 @@ void notifyCallback(NimBLERemoteCharacteristic* chr,
 #endif
 
     if (val == 0x01) {
-        if (now - lastBtnDedupMs < BTN_DEBOUNCE_MS) {
+        if (now - ses->lastBtnDedupMs < BTN_DEBOUNCE_MS) {
             return;
         }
-        lastBtnDedupMs = now;
-
-        clickCount++;
-        lastClickMs = now;
+        ses->lastBtnDedupMs = now;
+        lastCalibActivityMs = now;
+        calibNoteClick(*ses, now);
+
+        portENTER_CRITICAL(&sessionMux);
+        if (ses->clickCount < 255) ses->clickCount++;
+        portEXIT_CRITICAL(&sessionMux);
+        telemetryCounters.itagClicks++;
+        deadlines.scheduleIn(TIMER_CLICK_WINDOW, msToUs(CLICK_WINDOW_MS));
     }
 }
 
@@ -321,37 +1039,82 @@ void notifyCallback(NimBLERemoteCharacteristic* chr,
 // ======================================================================
 class ClientCallbacks : public NimBLEClientCallbacks {
     void onConnect(NimBLEClient* pClient) override {
-        Serial.printf(">> CONNECTED to %s\n",
-                      pClient->getPeerAddress().toString().c_str());
-        bleConnected = true;
-    }
+        connectPending       = false;
+        fastReconnectPending = false;
 
-    void onDisconnect(NimBLEClient* pClient, int reason) override {
-        Serial.printf(">> DISCONNECTED (reason=%d). Restart scan.\n", reason);
+        bleEventSeq++;
+        telemetryCounters.connects++;
 
-        bleConnected      = false;
-        isNear            = false;
-        nearFalseCount    = 0;
-        contactActive     = false;
-        sessionHadContact = false;
-        digitalWrite(CONTACT_RELAY, LOW);
+        Session* ses = sessionOpen(pClient, findKey(pClient->getPeerAddress()));
+        if (!ses) {
+            Serial.println("!! Slot sesi penuh → disconnect");
+            pClient->disconnect();
+            return;
+        }
 
-        manualState       = MANUAL_IDLE;
-        activationCount   = 0;
-        manualIndex       = 0;
-        digitPressCount   = 0;
+        Serial.printf(">> CONNECTED to %s (key #%d, sesi %u/%u)\n",
+                      pClient->getPeerAddress().toString().c_str(),
+                      ses->keyIndex, sessionCount, MAX_SESSIONS);
+        bleConnected = true;
+        deadlines.cancel(TIMER_SCAN_SLOW);
+        bootMark(BOOT_CONNECTED);
+        rememberKey(pClient->getPeerAddress());
 
-        gButtonChar = nullptr;
-        gBattChar   = nullptr;
+        // Masih ada key lain yang belum connect → tetap cari pelan-pelan
+        if (sessionCount < KEY_COUNT && sessionCount < MAX_SESSIONS) {
+            configureScanSlow();
+        }
+        energyRadio(ENERGY_CONNECTED);
+    }
 
-        indicatorDimmingActive = false;
-        battBlinkState         = false;
-        indicatorSet(0);
+    void onConnectFail(NimBLEClient* pClient, int reason) override {
+        Serial.printf(">> CONNECT FAILED (reason=%d)%s. Restart scan.\n",
+                      reason, fastReconnectPending ? " [fast reconnect]" : "");
+        bleEventSeq++;
+        telemetryCounters.connectFails++;
+        connectPending       = false;
+        fastReconnectPending = false;
+        rescanAfterLinkLoss();
+    }
 
-        // Setelah putus, mulai dari aggressive lagi,
-        // dan timer 30 detik dihitung dari sini.
-        unsigned long nowMs = millis();
-        configureScanAggressive(nowMs);
+    void onDisconnect(NimBLEClient* pClient, int reason) override {
+        bleEventSeq++;
+        telemetryCounters.disconnects++;
+
+        Session* ses = sessionByClient(pClient);
+        if (ses) {
+            // Supervision timeout = key keluar jangkauan → sampel FAR pasti
+            if (reason == BLE_HS_ERR_HCI_BASE + BLE_ERR_CONN_SPVN_TMO) {
+                telemetryCounters.supervisionTimeouts++;
+                calibNoteFar(*ses);
+            }
+            sessionClose(ses);
+        }
+
+        Serial.printf(">> DISCONNECTED (reason=%d, sisa %u sesi). Restart scan.\n",
+                      reason, sessionCount);
+
+        if (sessionCount == 0) {
+            bleConnected      = false;
+            isNear            = false;
+            nearestSession    = -1;
+            sessionHadContact = false;
+            contactOff();
+
+            manualState       = MANUAL_IDLE;
+            activationCount   = 0;
+            manualIndex       = 0;
+            digitPressCount   = 0;
+            deadlines.cancel(TIMER_DIGIT_WINDOW);
+            deadlines.cancel(TIMER_CLICK_WINDOW);
+            deadlines.cancel(TIMER_BATTERY_POLL);
+
+            indicatorDimmingActive = false;
+            battBlinkState         = false;
+            indicatorSet(0);
+        }
+
+        rescanAfterLinkLoss();
     }
 } clientCallbacks;
 
@@ -359,37 +1122,50 @@ class ClientCallbacks : public NimBLEClientCallbacks {
 //  SCAN CALLBACKS
 // ======================================================================
 class ScanCallbacks : public NimBLEScanCallbacks {
-    bool matchManufacturer(const NimBLEAdvertisedDevice* dev) {
-        if (ITAG_MFG_PREFIX_LEN == 0) return true;
+    // Parse payload langsung, getManufacturerData() bikin std::string baru
+    bool matchManufacturer(const NimBLEAdvertisedDevice* dev, const AuthorizedKey& key) {
+        if (!key.mfgPrefix || key.mfgPrefixLen == 0) return true;
 
-        std::string mfg = dev->getManufacturerData();
-        if (mfg.size() < ITAG_MFG_PREFIX_LEN) return false;
+        const std::vector<uint8_t>& payload = dev->getPayload();
+        AdvSample adv;
+        if (!advParsePayload(payload.data(), payload.size(), adv) || !adv.mfg) return false;
+        if (adv.mfgLen < key.mfgPrefixLen) return false;
 
-        return (memcmp(mfg.data(), ITAG_MFG_PREFIX, ITAG_MFG_PREFIX_LEN) == 0);
+        return (memcmp(adv.mfg, key.mfgPrefix, key.mfgPrefixLen) == 0);
     }
 
     void onResult(const NimBLEAdvertisedDevice* dev) override {
 
-        String mac = dev->getAddress().toString().c_str();
-        if (mac != TARGET_MAC) {
+        int8_t key = findKey(dev->getAddress());
+        if (key < 0) {
+            return;
+        }
+
+        // key ini sudah punya sesi / lagi ada connect lain yang jalan
+        if (connectPending || keyHasSession(key) || sessionCount >= MAX_SESSIONS) {
             return;
         }
 
         if (!(dev->haveServiceUUID() &&
-              dev->isAdvertisingService(NimBLEUUID(ITAG_SERVICE_UUID)))) {
+              dev->isAdvertisingService(ITAG_SERVICE))) {
             DBGLN(">> MATCH MAC tapi service FFE0 tidak ada → ignore");
             return;
         }
 
-        if (!matchManufacturer(dev) && currentScanMode == SCAN_MODE_AGGRESSIVE) {
+        if (!matchManufacturer(dev, AUTHORIZED_KEYS[key]) && currentScanMode == SCAN_MODE_AGGRESSIVE) {
             DBGLN(">> MATCH MAC + service, MFG beda → ignore");
             return;
         }
 
-        Serial.println(">> MATCH: TARGET DEVICE FOUND");
+        Serial.printf(">> MATCH: KEY #%d FOUND\n", key);
+        bootMark(BOOT_KEY_FOUND);
+        bleEventSeq++;
 
         NimBLEScan* scan = NimBLEDevice::getScan();
         scan->stop();
+        if (sessionCount == 0) {
+            energyRadio(ENERGY_IDLE);   // radio diam sampai connect selesai
+        }
 
         NimBLEClient* client = NimBLEDevice::getDisconnectedClient();
         if (!client) {
@@ -402,11 +1178,16 @@ class ScanCallbacks : public NimBLEScanCallbacks {
         }
 
         client->setClientCallbacks(&clientCallbacks, false);
+        client->setConnectTimeout(CONNECT_TIMEOUT_MS);
 
-        if (!client->connect(true, true, false)) {
+        // client bekas bisa milik key lain → selalu connect ke alamat advert ini
+        if (!client->connect(dev->getAddress(), true, true, false)) {
             Serial.println("!! Async connect failed");
             NimBLEDevice::deleteClient(client);
+            configureScanAggressive(millis());
+            return;
         }
+        connectPending = true;
     }
 
     void onScanEnd(const NimBLEScanResults& results, int reason) override {
@@ -420,46 +1201,68 @@ class ScanCallbacks : public NimBLEScanCallbacks {
 // ======================================================================
 void configureScanAggressive(unsigned long nowMs) {
     NimBLEScan* scan = NimBLEDevice::getScan();
-    scan->stop();
-    scan->setInterval(45);
-    scan->setWindow(45);
+    if (scan->isScanning()) scan->stop();   // waktu boot belum scanning, skip
+    scan->setInterval(SCAN_AGGR_INTERVAL_MS);
+    scan->setWindow(SCAN_AGGR_WINDOW_MS);
     scan->setActiveScan(true);
     scan->start(5000);
+    energyRadio(ENERGY_SCAN_ACTIVE, energyScanDuty(SCAN_AGGR_INTERVAL_MS, SCAN_AGGR_WINDOW_MS));
+    bootMark(BOOT_SCAN_START);
 
-    currentScanMode           = SCAN_MODE_AGGRESSIVE;
-    lastAggressiveScanStartMs = nowMs;  // RESET timer 30 detik di sini
+    currentScanMode = SCAN_MODE_AGGRESSIVE;
+    bleEventSeq++;   // ganti mode scan: stop/start NimBLE boleh alokasi
+    deadlines.scheduleIn(TIMER_SCAN_SLOW, msToUs(SCAN_AGGRESSIVE_HOLD_MS));  // RESET timer 30 detik di sini
     DBGLN("[SCAN] Aggressive scan configured");
 }
 
 void configureScanSlow() {
     NimBLEScan* scan = NimBLEDevice::getScan();
     scan->stop();
-    scan->setInterval(320);
-    scan->setWindow(40);
+    scan->setInterval(SCAN_SLOW_INTERVAL_MS);
+    scan->setWindow(SCAN_SLOW_WINDOW_MS);
     scan->setActiveScan(false);
     scan->start(5000);
+    energyRadio(ENERGY_SCAN_PASSIVE, energyScanDuty(SCAN_SLOW_INTERVAL_MS, SCAN_SLOW_WINDOW_MS));
 
     currentScanMode = SCAN_MODE_SLOW;
+    bleEventSeq++;
+    deadlines.cancel(TIMER_SCAN_SLOW);
     DBGLN("[SCAN] Slow (passive) scan configured");
 }
 
+// Setelah connect gagal / putus. Tanpa sesi: mulai dari aggressive lagi,
+// timer 30 detik dihitung dari sini. Masih ada key connect: key lain
+// cukup dicari pelan-pelan (fob cadangan di rumah = scan selamanya).
+void rescanAfterLinkLoss() {
+    if (sessionCount == 0) {
+        configureScanAggressive(millis());
+        return;
+    }
+    configureScanSlow();
+    energyRadio(ENERGY_CONNECTED);
+}
+
 // ======================================================================
 //  DISCOVER SERVICES
 // ======================================================================
-void discoverServices(NimBLEClient* client)
+// ses = salinan slot idx (loop); hasil ditulis balik lewat sessionCommit()
+void discoverServices(uint8_t idx, Session& ses)
 {
-    DBGLN(">> Discovering services...");
+    DBG(">> Discovering services key #%d...\n", ses.keyIndex);
+    NimBLEClient* client = ses.client;
+    bleEventSeq++;
 
     NimBLERemoteService* svcButton =
-        client->getService(NimBLEUUID(ITAG_SERVICE_UUID));
+        client->getService(ITAG_SERVICE);
     if (svcButton) {
         DBGLN("  SERVICE FFE0 found");
         NimBLERemoteCharacteristic* chrButton =
-            svcButton->getCharacteristic(NimBLEUUID(ITAG_CHAR_UUID));
+            svcButton->getCharacteristic(ITAG_CHAR);
         if (chrButton && (chrButton->canNotify() || chrButton->canIndicate())) {
             DBGLN("  >> Subscribing BUTTON FFE1");
             if (chrButton->subscribe(true, notifyCallback, true)) {
-                gButtonChar = chrButton;
+                routeAdd(idx, ses, chrButton->getHandle(), NOTIFY_BUTTON);
+                ses.buttonChar = chrButton;
                 DBGLN("  >> BUTTON subscribed OK");
             } else {
                 Serial.println("  !! BUTTON subscribe FAILED");
@@ -472,16 +1275,24 @@ void discoverServices(NimBLEClient* client)
     }
 
     NimBLERemoteService* svcBatt =
-        client->getService(NimBLEUUID(BATTERY_SERVICE_UUID));
+        client->getService(BATTERY_SERVICE);
     if (svcBatt) {
         DBGLN("  SERVICE 180F (Battery) found");
         NimBLERemoteCharacteristic* chrBatt =
-            svcBatt->getCharacteristic(NimBLEUUID(BATTERY_CHAR_UUID));
+            svcBatt->getCharacteristic(BATTERY_CHAR);
         if (chrBatt) {
-            gBattChar = chrBatt;
+            ses.battChar   = chrBatt;
+            ses.battHandle = chrBatt->getHandle();
+            if (!deadlines.pending(TIMER_BATTERY_POLL)) {
+                deadlines.scheduleIn(TIMER_BATTERY_POLL, msToUs(BATTERY_POLL_MS));
+            }
             if (chrBatt->canNotify() || chrBatt->canIndicate()) {
                 DBGLN("  >> Subscribing BATTERY 2A19");
-                chrBatt->subscribe(true, notifyCallback, true);
+                if (chrBatt->subscribe(true, notifyCallback, true)) {
+                    routeAdd(idx, ses, ses.battHandle, NOTIFY_BATTERY);
+                } else {
+                    Serial.println("  !! BATTERY subscribe FAILED");
+                }
             } else {
                 DBGLN("  >> BATTERY 2A19 READ-ONLY");
             }
@@ -501,6 +1312,7 @@ void resetManual(bool errorBlink) {
     activationCount = 0;
     manualIndex     = 0;
     digitPressCount = 0;
+    deadlines.cancel(TIMER_DIGIT_WINDOW);
 
     if (errorBlink) {
         Serial.println("[MANUAL] Kode salah, reset");
@@ -512,15 +1324,15 @@ void startManualCode(unsigned long nowMs) {
     manualState     = MANUAL_CODE;
     manualIndex     = 0;
     digitPressCount = 0;
-    digitStartMs    = nowMs;
+    deadlines.scheduleIn(TIMER_DIGIT_WINDOW, msToUs(DIGIT_WINDOW_MS));
 
     Serial.println("[MANUAL] Mode manual aktif, masukkan kode 2-3-1-0");
     ledBlink(3, 150, 150);
 }
 
+// Dipanggil waktu TIMER_DIGIT_WINDOW habis
 void processDigitTimeout(unsigned long nowMs) {
     if (manualState != MANUAL_CODE) return;
-    if (nowMs - digitStartMs <= DIGIT_WINDOW_MS) return;
 
     uint8_t expected = CODE_PATTERN[manualIndex];
     uint8_t actual   = digitPressCount;
@@ -540,16 +1352,12 @@ void processDigitTimeout(unsigned long nowMs) {
         Serial.println("[MANUAL] KODE BENAR, CONTACT ON 7 DETIK");
         ledBlink(3, 200, 150);
 
-        contactActive     = true;
-        contactDurationMs = CONTACT_MANUAL_ON_MS;
-        contactOnStartMs  = nowMs;
-        sessionHadContact = true;
-        digitalWrite(CONTACT_RELAY, HIGH);
+        contactOn(CONTACT_MANUAL_ON_MS);
 
         resetManual(false);
     } else {
         digitPressCount = 0;
-        digitStartMs    = nowMs;
+        deadlines.scheduleIn(TIMER_DIGIT_WINDOW, msToUs(DIGIT_WINDOW_MS));
     }
 }
 
@@ -557,15 +1365,16 @@ void processDigitTimeout(unsigned long nowMs) {
 //  HANDLE TRIGGER
 // ======================================================================
 void handleTriggerPress(unsigned long nowMs) {
-    // 5x trigger dalam 5 detik → restart
-    if (rebootTriggerCount == 0 || (nowMs - rebootWindowStartMs > REBOOT_WINDOW_MS)) {
-        rebootTriggerCount  = 0;
-        rebootWindowStartMs = nowMs;
+    telemetryCounters.triggerPresses++;
+    lastCalibActivityMs = nowMs;
+
+    // 5x trigger dalam 5 detik → restart (TIMER_REBOOT_WINDOW reset hitungan)
+    if (rebootTriggerCount == 0) {
+        deadlines.scheduleIn(TIMER_REBOOT_WINDOW, msToUs(REBOOT_WINDOW_MS));
     }
     rebootTriggerCount++;
 
-    DBG("[REBOOT] count=%u, window=%lu ms\n",
-        rebootTriggerCount, nowMs - rebootWindowStartMs);
+    DBG("[REBOOT] count=%u\n", rebootTriggerCount);
 
     if (rebootTriggerCount == REBOOT_TRIGGER_TARGET) {
         Serial.println("[SYS] 5x trigger dalam 5 detik → RESTART");
@@ -594,14 +1403,9 @@ void handleTriggerPress(unsigned long nowMs) {
         return;
     }
 
-    // Triple trigger → masuk mode manual
+    // Triple trigger → masuk mode manual (window ditutup TIMER_ACTIVATION_WINDOW)
     if (activationCount == 0) {
-        activationStartMs = nowMs;
-    }
-
-    if (nowMs - activationStartMs > ACTIVATION_WINDOW_MS) {
-        activationCount   = 0;
-        activationStartMs = nowMs;
+        deadlines.scheduleIn(TIMER_ACTIVATION_WINDOW, msToUs(ACTIVATION_WINDOW_MS));
     }
 
     activationCount++;
@@ -612,14 +1416,436 @@ void handleTriggerPress(unsigned long nowMs) {
     }
 
     // Mode auto: satu trigger + BLE connect + NEAR + kontak belum aktif
+    bool unlocked = false;
     if (bleConnected && isNear && !contactActive) {
-        contactActive     = true;
-        contactDurationMs = CONTACT_AUTO_ON_MS;
-        contactOnStartMs  = nowMs;
-        sessionHadContact = true;
-        digitalWrite(CONTACT_RELAY, HIGH);
+        contactOn(CONTACT_AUTO_ON_MS);
+        unlocked = true;
         Serial.println("[CONTACT] AUTO ON (BLE+near+trigger, 3 detik)");
     }
+
+    // Sampel kalibrasi near: hanya kalau unlock / nanti dikonfirmasi klik iTAG
+    Session nearest;
+    if (bleConnected && nearestSession >= 0 && sessionSnapshot(nearestSession, nearest)) {
+        calibNotePress(nearest, nowMs, unlocked);
+    }
+}
+
+// ======================================================================
+//  AKSI KLIK ITAG & POLL BATERAI
+// ======================================================================
+void runClickAction(uint8_t count) {
+    if (count == 1) {
+        Serial.println("[ACTION] iTAG SINGLE CLICK → SEIN BLINK 2x");
+        for (int i = 0; i < 2; i++) {
+            relayWrite(ENERGY_RELAY_SEIN, true);
+            delay(120);
+            relayWrite(ENERGY_RELAY_SEIN, false);
+            delay(120);
+        }
+    } else {
+        Serial.printf("[ACTION] iTAG MULTI (%u) → HORN BLINK 2x\n", count);
+        relayWrite(ENERGY_RELAY_HORN, true);
+        delay(300);
+        relayWrite(ENERGY_RELAY_HORN, false);
+        delay(200);
+        relayWrite(ENERGY_RELAY_HORN, true);
+        delay(300);
+        relayWrite(ENERGY_RELAY_HORN, false);
+    }
+}
+
+// Hitungan klik per sesi: dua key yang diklik bareng tidak jadi satu MULTI
+void handleClickAction() {
+    for (uint8_t i = 0; i < MAX_SESSIONS; ++i) {
+        portENTER_CRITICAL(&sessionMux);
+        uint8_t count = sessions[i].used ? sessions[i].clickCount : 0;
+        sessions[i].clickCount = 0;
+        portEXIT_CRITICAL(&sessionMux);
+
+        if (count > 0) runClickAction(count);
+    }
+}
+
+// Hasil GATT read mentah (task NimBLE). arg = index sesi.
+int onBatteryRead(uint16_t connHandle, const struct ble_gatt_error* error,
+                  struct ble_gatt_attr* attr, void* arg)
+{
+    Session& ses = sessions[(uintptr_t)arg];
+    if (error->status != 0 || !attr || !ses.used || ses.connHandle != connHandle) {
+        return 0;
+    }
+
+    uint8_t level;
+    if (os_mbuf_copydata(attr->om, 0, 1, &level) == 0) {
+        ses.batteryPercent = level;
+        ses.batteryLow     = (level < 20);
+#ifdef ReadMessage
+        Serial.printf("[BATT-POLL] key #%d level=%u%%  low=%d\n",
+                      ses.keyIndex, level, ses.batteryLow);
+#endif
+    }
+    return 0;
+}
+
+// readValue() blocking + bikin std::string; di sini async tanpa alokasi.
+void pollBattery() {
+    bool any = false;
+
+    for (uint8_t i = 0; i < MAX_SESSIONS; ++i) {
+        Session ses;
+        if (!sessionSnapshot(i, ses) || !ses.battChar) continue;
+        any = true;
+
+        int rc = ble_gattc_read(ses.connHandle, ses.battHandle, onBatteryRead, (void*)(uintptr_t)i);
+        if (rc != 0) {
+            DBG("[BATT-POLL] key #%d read gagal rc=%d\n", ses.keyIndex, rc);
+        }
+    }
+
+    if (any) {
+        deadlines.scheduleIn(TIMER_BATTERY_POLL, msToUs(BATTERY_POLL_MS));
+    }
+}
+
+// ======================================================================
+//  RSSI PER SESI & PEMILIHAN KEY TERDEKAT
+// ======================================================================
+void updateSessionRssi(Session& ses, unsigned long nowMs) {
+    if (nowMs - ses.lastRssiUpdate < 1000) return;
+    ses.lastRssiUpdate = nowMs;
+
+    int rssi = ses.client->getRssi();
+
+    const float alpha = 0.2f;
+    ses.rssiAvg = alpha * rssi + (1.0f - alpha) * ses.rssiAvg;
+    if (ses.rssiSamples < 255) ses.rssiSamples++;
+    TRACE_RSSI(nowMs, ses.keyIndex, ses.rssiAvg, 'S');
+
+    const char* zone = classifyDistance(ses.rssiAvg);
+    if (zone != ses.lastZone) {
+        DBG("[DIST] key #%d RSSI avg=%.1f dBm → %s\n", ses.keyIndex, ses.rssiAvg, zone);
+        ses.lastZone = zone;
+    }
+
+    RssiThresholds th = { RSSI_NEAR_THRESHOLD, RSSI_FAR_THRESHOLD, false };
+    if (ses.keyIndex >= 0) th = calibThresholds(ses.keyIndex);
+
+    if (!ses.isNear && ses.rssiAvg >= th.nearDbm) {
+        ses.isNear = true;
+        ses.nearFalseCount = 0;
+        Serial.printf("[DIST] key #%d <2m → NEAR = true\n", ses.keyIndex);
+    } else if (ses.isNear && ses.rssiAvg <= th.farDbm) {
+        ses.isNear = false;
+        Serial.printf("[DIST] key #%d >2m → NEAR = false\n", ses.keyIndex);
+    }
+
+    calibNoteIdleFar(ses, nowMs, th.farDbm);
+
+    if (!ses.isNear) {
+        if (ses.nearFalseCount < 5) {
+            ses.nearFalseCount++;
+        }
+    } else {
+        ses.nearFalseCount = 0;
+    }
+}
+
+// Keputusan unlock pakai key terdekat (RSSI rata-rata tertinggi).
+void selectNearestKey() {
+    int8_t  best = -1;
+    Session n;
+    portENTER_CRITICAL(&sessionMux);
+    for (uint8_t i = 0; i < MAX_SESSIONS; ++i) {
+        if (!sessions[i].used) continue;
+        if (best < 0 || sessions[i].rssiAvg > sessions[best].rssiAvg) {
+            best = (int8_t)i;
+        }
+    }
+    if (best >= 0) n = sessions[best];
+    portEXIT_CRITICAL(&sessionMux);
+
+    nearestSession = best;
+    if (best < 0) {
+        isNear     = false;
+        nearestKey = -1;
+        return;
+    }
+
+    nearestKey     = n.keyIndex;
+    rssiAvg        = n.rssiAvg;
+    isNear         = n.isNear;
+    batteryPercent = n.batteryPercent;
+    batteryLow     = n.batteryLow;
+
+    if (n.nearFalseCount == 5 && sessionHadContact) {
+        sessionHadContact = false;
+        Serial.println("[DIST] FAR → sessionHadContact reset");
+    }
+}
+
+// ======================================================================
+//  TELEMETRY GATT: server, snapshot state, notify ter-coalesce
+//  Notify dari loop() saja dan tidak blocking (mbuf NimBLE), jadi HP
+//  servis yang subscribe tidak menambah traffic per event.
+// ======================================================================
+#ifdef TelemetryGatt
+// Task NimBLE (subscribe/disconnect)
+void telemetrySubAdd(TelemetrySubscribers& subs, uint16_t conn) {
+    portENTER_CRITICAL(&telemetryMux);
+    bool known = false;
+    for (uint8_t i = 0; i < subs.count; ++i) known |= (subs.conn[i] == conn);
+    if (!known && subs.count < TELEMETRY_MAX_SUBSCRIBERS) subs.conn[subs.count++] = conn;
+    portEXIT_CRITICAL(&telemetryMux);
+}
+
+void telemetrySubRemove(TelemetrySubscribers& subs, uint16_t conn) {
+    portENTER_CRITICAL(&telemetryMux);
+    for (uint8_t i = 0; i < subs.count; ++i) {
+        if (subs.conn[i] != conn) continue;
+        subs.conn[i] = subs.conn[--subs.count];
+        break;
+    }
+    portEXIT_CRITICAL(&telemetryMux);
+}
+
+// loop(): kirim value sekarang ke subscriber terautentikasi saja
+void telemetryNotify(NimBLECharacteristic* chr, const TelemetrySubscribers& subs) {
+    portENTER_CRITICAL(&telemetryMux);
+    TelemetrySubscribers to = subs;
+    portEXIT_CRITICAL(&telemetryMux);
+
+    for (uint8_t i = 0; i < to.count; ++i) {
+        if (chr->notify(to.conn[i])) telemetryCounters.notifies++;
+    }
+}
+
+class TelemetryServerCallbacks : public NimBLEServerCallbacks {
+    void onConnect(NimBLEServer* server, NimBLEConnInfo& info) override {
+        bleEventSeq++;
+        energyAdvertising(false);   // NimBLE berhenti advertising saat ada koneksi
+        Serial.println("[TELEMETRY] HP servis connect, minta pairing");
+        NimBLEDevice::startSecurity(info.getConnHandle());
+    }
+
+    void onAuthenticationComplete(NimBLEConnInfo& info) override {
+        if (!info.isEncrypted() || !info.isAuthenticated() || !info.isBonded()) {
+            Serial.println("[TELEMETRY] !! pairing gagal, putuskan");
+            NimBLEDevice::getServer()->disconnect(info.getConnHandle());
+            return;
+        }
+        Serial.println("[TELEMETRY] HP servis terautentikasi");
+    }
+
+    void onDisconnect(NimBLEServer* server, NimBLEConnInfo& info, int reason) override {
+        bleEventSeq++;
+        telemetrySubRemove(telemetryStatusSubs, info.getConnHandle());
+        telemetrySubRemove(telemetryCountersSubs, info.getConnHandle());
+        Serial.printf("[TELEMETRY] HP servis putus (reason=%d)\n", reason);
+        // advertising jalan lagi otomatis (advertiseOnDisconnect default)
+        energyAdvertising(true);
+    }
+} telemetryServerCallbacks;
+
+// Subscriber terautentikasi langsung dapat record terbaru, tidak tunggu
+// heartbeat. Subscribe dari link tanpa MITM pairing diabaikan + diputus.
+class TelemetryCharCallbacks : public NimBLECharacteristicCallbacks {
+    void onSubscribe(NimBLECharacteristic* chr, NimBLEConnInfo& info, uint16_t subValue) override {
+        TelemetrySubscribers& subs =
+            (chr == telemetryStatusChar) ? telemetryStatusSubs : telemetryCountersSubs;
+
+        if (subValue == 0) {
+            telemetrySubRemove(subs, info.getConnHandle());
+            return;
+        }
+        if (!info.isEncrypted() || !info.isAuthenticated()) {
+            Serial.println("[TELEMETRY] !! subscribe tanpa pairing, putuskan");
+            NimBLEDevice::getServer()->disconnect(info.getConnHandle());
+            return;
+        }
+
+        telemetrySubAdd(subs, info.getConnHandle());
+        if (chr == telemetryStatusChar)   telemetryStatusCo.resync();
+        if (chr == telemetryCountersChar) telemetryCountersCo.resync();
+    }
+} telemetryCharCallbacks;
+
+void setupTelemetry() {
+    telemetryStatusCo.begin(TELEMETRY_STATUS_MIN_MS, TELEMETRY_HEARTBEAT_MS, TELEMETRY_STATUS_LEN);
+    telemetryCountersCo.begin(TELEMETRY_COUNTERS_MIN_MS, TELEMETRY_HEARTBEAT_MS,
+                              TELEMETRY_COUNTERS_CMP);
+
+    // Bonding + MITM (passkey) + secure connections. Client ke iTag tidak
+    // pernah minta security, jadi cuma berlaku untuk HP servis.
+    NimBLEDevice::setSecurityAuth(true, true, true);
+    NimBLEDevice::setSecurityIOCap(BLE_HS_IO_DISPLAY_ONLY);
+    NimBLEDevice::setSecurityPasskey(TELEMETRY_PASSKEY);
+
+    NimBLEServer* server = NimBLEDevice::createServer();
+    server->setCallbacks(&telemetryServerCallbacks);
+
+    // READ_ENC + READ_AUTHEN: read tanpa link terenkripsi-terautentikasi
+    // ditolak stack (ATT insufficient authentication → HP mulai pairing).
+    // CCCD NOTIFY tidak ikut dilindungi flag ini → dicek di onSubscribe.
+    const uint32_t props = NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::READ_ENC |
+                           NIMBLE_PROPERTY::READ_AUTHEN | NIMBLE_PROPERTY::NOTIFY;
+    NimBLEService* svc = server->createService(TELEMETRY_SERVICE_UUID);
+    telemetryStatusChar = svc->createCharacteristic(
+        TELEMETRY_STATUS_UUID, props, TELEMETRY_STATUS_LEN);
+    telemetryCountersChar = svc->createCharacteristic(
+        TELEMETRY_COUNTERS_UUID, props, TELEMETRY_COUNTERS_LEN);
+    telemetryStatusChar->setCallbacks(&telemetryCharCallbacks);
+    telemetryCountersChar->setCallbacks(&telemetryCharCallbacks);
+    svc->start();
+
+    // Advertising pelan: cuma supaya HP servis bisa menemukan motor
+    NimBLEAdvertising* adv = NimBLEDevice::getAdvertising();
+    adv->addServiceUUID(NimBLEUUID(TELEMETRY_SERVICE_UUID));
+    adv->setMinInterval(TELEMETRY_ADV_MIN_UNITS);
+    adv->setMaxInterval(TELEMETRY_ADV_MAX_UNITS);
+    adv->start();
+    energyAdvertising(true);
+}
+
+void telemetrySnapshot(TelemetryStatus& st) {
+    st = TelemetryStatus{};
+    if (bleConnected)                       st.flags |= TELEMETRY_F_CONNECTED;
+    if (isNear)                             st.flags |= TELEMETRY_F_NEAR;
+    if (contactActive)                      st.flags |= TELEMETRY_F_CONTACT;
+    if (currentScanMode == SCAN_MODE_SLOW)  st.flags |= TELEMETRY_F_SCAN_SLOW;
+    if (batteryLow)                         st.flags |= TELEMETRY_F_BATT_LOW;
+    if (manual_mode)                        st.flags |= TELEMETRY_F_MANUAL;
+
+    st.rssiAvg    = TELEMETRY_RSSI_NONE;
+    st.nearDbm    = RSSI_NEAR_THRESHOLD;
+    st.farDbm     = RSSI_FAR_THRESHOLD;
+    st.nearestKey = -1;
+    if (nearestSession >= 0) {
+        st.rssiAvg    = (int8_t)lroundf(rssiAvg);
+        st.nearestKey = nearestKey;
+        if (nearestKey >= 0) {
+            RssiThresholds th = calibThresholds(nearestKey);
+            st.nearDbm = th.nearDbm;
+            st.farDbm  = th.farDbm;
+            if (th.calibrated) st.flags |= TELEMETRY_F_CALIBRATED;
+        }
+    }
+
+    st.batteryPercent  = batteryPercent < 0 ? TELEMETRY_BATTERY_UNKNOWN : (uint8_t)batteryPercent;
+    st.sessionCount    = sessionCount;
+    st.manualState     = (uint8_t)manualState;
+    st.activationCount = activationCount;
+}
+
+void updateTelemetry(unsigned long nowMs) {
+    if (!telemetryStatusChar) return;
+    uint8_t buf[TELEMETRY_MAX_LEN];
+
+    TelemetryStatus st;
+    telemetrySnapshot(st);
+    size_t len = telemetryEncodeStatus(st, buf);
+    if (telemetryStatusCo.offer(nowMs, buf, (uint8_t)len)) {
+        telemetryStatusChar->setValue(buf, len);
+        telemetryNotify(telemetryStatusChar, telemetryStatusSubs);
+    }
+
+    telemetryCounters.bootCount        = (uint16_t)bootCache.bootCount;
+    telemetryCounters.contactLateMaxUs = deadlines.maxLateUs(TIMER_CONTACT_OFF);
+    telemetryCounters.freeHeap         = ESP.getFreeHeap();
+    telemetryCounters.uptimeS          = nowMs / 1000;
+    len = telemetryEncodeCounters(telemetryCounters, buf);
+    if (telemetryCountersCo.offer(nowMs, buf, (uint8_t)len)) {
+        telemetryCountersChar->setValue(buf, len);
+        telemetryNotify(telemetryCountersChar, telemetryCountersSubs);
+    }
+}
+#endif
+
+// ======================================================================
+//  CEK ALOKASI HEAP (env *-alloccheck)
+//  Steady state = window tanpa connect/disconnect/connect gagal/discovery,
+//  tanpa ganti mode scan (bleEventSeq tidak berubah), tanpa tulis NVS
+//  (allocWindowDirty) dan TANPA scan aktif. NimBLE-Arduino 2.x membuat
+//  NimBLEAdvertisedDevice + push_back vector untuk setiap advert, walau
+//  setMaxResults(0) (hasilnya cuma langsung dihapus lagi), jadi window
+//  yang scan (multi-key yang masih cari key lain) tidak bisa nol alokasi.
+// ======================================================================
+#ifdef ALLOC_COUNTER
+void reportAllocations() {
+    static uint32_t lastCount = 0;
+    static uint32_t lastBytes = 0;
+    static uint32_t lastSeq   = 0;
+
+    uint32_t count = allocCounterCount();
+    uint32_t bytes = allocCounterBytes();
+    uint32_t seq   = bleEventSeq;
+    bool steady    = (seq == lastSeq) && !allocWindowDirty &&
+                     !NimBLEDevice::getScan()->isScanning();
+    allocWindowDirty = false;
+
+    uint32_t dCount = count - lastCount;
+    uint32_t dBytes = bytes - lastBytes;
+    lastCount = count;
+    lastBytes = bytes;
+    lastSeq   = seq;
+
+    if (steady && dCount != 0) {
+        Serial.printf("[HEAP] !! %lu alokasi (%lu B) di steady state\n",
+                      (unsigned long)dCount, (unsigned long)dBytes);
+    } else {
+        Serial.printf("[HEAP] %lu alokasi (%lu B)%s, free %lu\n",
+                      (unsigned long)dCount, (unsigned long)dBytes,
+                      steady ? " steady" : "", (unsigned long)ESP.getFreeHeap());
+    }
+}
+#endif
+
+// ======================================================================
+//  EVENT DEADLINE
+// ======================================================================
+void handleDeadlineEvents(unsigned long nowMs) {
+    uint32_t ev = deadlines.takeEvents();
+    if (ev == 0) return;
+
+    if (ev & deadlineBit(TIMER_CONTACT_OFF)) {
+        // coil sudah OFF dari callback; di sini state + accounting
+        contactActive = false;
+        relayWrite(ENERGY_RELAY_CONTACT, false);
+        Serial.printf("[CONTACT] OFF (timeout, jitter %lu us, max %lu us)\n",
+                      (unsigned long)deadlines.lastLateUs(TIMER_CONTACT_OFF),
+                      (unsigned long)deadlines.maxLateUs(TIMER_CONTACT_OFF));
+    }
+
+    if (ev & deadlineBit(TIMER_REBOOT_WINDOW)) {
+        rebootTriggerCount = 0;
+    }
+
+    if (ev & deadlineBit(TIMER_ACTIVATION_WINDOW)) {
+        activationCount = 0;
+        if (manual_mode) {
+            manual_mode = false;
+            startManualCode(nowMs);
+        }
+    }
+
+    if (ev & deadlineBit(TIMER_DIGIT_WINDOW)) {
+        processDigitTimeout(nowMs);
+    }
+
+    if (ev & deadlineBit(TIMER_CLICK_WINDOW)) {
+        handleClickAction();
+    }
+
+    // ADAPTIVE SCAN: 30 detik di AGGRESSIVE tanpa key baru → SLOW
+    if ((ev & deadlineBit(TIMER_SCAN_SLOW)) &&
+        sessionCount < KEY_COUNT && currentScanMode == SCAN_MODE_AGGRESSIVE) {
+        Serial.println("[SCAN] >30s tanpa key baru, switch ke SLOW scan");
+        configureScanSlow();
+        if (sessionCount > 0) energyRadio(ENERGY_CONNECTED);
+    }
+
+    if (ev & deadlineBit(TIMER_BATTERY_POLL)) {
+        pollBattery();
+    }
 }
 
 // ======================================================================
@@ -694,35 +1920,87 @@ unsigned long lastHBMs   = 0;
 bool          hbLedState = false;
 
 void setup() {
-    Serial.begin(115200);
-    Serial.println("=== ESP32-C3 SUPER MINI — iTAG CONTROL ===");
+    bootMark(BOOT_SETUP_ENTER);
 
-    pinMode(LED_BUILTIN, OUTPUT);
+    // Relay paling dulu. pinMode dulu baru digitalWrite: di Arduino 3.x
+    // digitalWrite ke pin yang belum di-attach (pinMode) diabaikan. Register
+    // output GPIO setelah reset = 0, jadi pin langsung LOW begitu jadi output.
     pinMode(CONTACT_RELAY, OUTPUT);
     pinMode(HORN_RELAY, OUTPUT);
     pinMode(SEIN_RELAY, OUTPUT);
-    pinMode(CONTACT_TRIGGER, INPUT_PULLUP);
-    pinMode(INDICATOR_LED, OUTPUT);
-
     digitalWrite(CONTACT_RELAY, LOW);
     digitalWrite(HORN_RELAY, LOW);
     digitalWrite(SEIN_RELAY, LOW);
+    pinMode(CONTACT_TRIGGER, INPUT_PULLUP);
+    bootMark(BOOT_GPIO_SAFE);
 
-    indicatorSet(0);
+    deadlineClock.begin(&deadlines);
+    deadlines.begin(&deadlineClock);
+    deadlines.setCallback(TIMER_CONTACT_OFF, onContactDeadline);
 
+    // Pin relay sudah LOW + OUTPUT di atas; LEDC ambil alih dengan duty 0
+    relayOutput.begin(RELAY_PINS, ENERGY_RELAY_COUNT);
+    relays.begin(&relayOutput, &deadlines, TIMER_RELAY_HOLD, ENERGY_RELAY_COUNT);
+    for (uint8_t r = 0; r < ENERGY_RELAY_COUNT; ++r) {
+        relays.setProfile(r, RELAY_PROFILES[r]);
+    }
+    relays.setHook(onRelayDrive);
+
+    esp_reset_reason_t reason = esp_reset_reason();
+    if (reason == ESP_RST_POWERON || !bootCacheValid(bootCache)) {
+        bootCacheReset(bootCache);
+    }
+    bootCache.bootCount++;
+    bootCacheSeal(bootCache);
+
+    energy.begin(millis(), ENERGY_IDLE);
+    rssiCalib.begin(RSSI_NEAR_THRESHOLD, RSSI_FAR_THRESHOLD);   // histogram NVS menyusul
+
+    // "Cache setting controller" tidak dikerjakan di sini: config controller
+    // BT (esp_bt_controller_config_t) sudah fix di library prebuilt Arduino,
+    // dan data kalibrasi PHY sudah di-cache di NVS oleh core
+    // (CONFIG_ESP_PHY_CALIBRATION_AND_DATA_STORAGE → kalibrasi parsial).
+    // Skip kalibrasi total (PHY_RF_CAL_NONE) cuma dipilih IDF setelah
+    // bangun dari deep sleep; firmware ini tidak pakai deep sleep. Yang
+    // tersisa butuh build IDF sendiri, bukan perubahan sketch.
     NimBLEDevice::init("Async-Client-C3");
     NimBLEDevice::setPower(3);
+    bootMark(BOOT_BLE_INIT);
+
+    for (uint8_t k = 0; k < KEY_COUNT; ++k) {
+        NimBLEAddress addr(std::string(AUTHORIZED_KEYS[k].mac), BLE_ADDR_PUBLIC);
+        memcpy(keyAddrVal[k], addr.getVal(), 6);
+    }
 
     NimBLEScan* scan = NimBLEDevice::getScan();
     scan->setScanCallbacks(&scanCallbacks);
+    scan->setMaxResults(0);   // hasil tidak menumpuk (alokasi per advert tetap ada)
 
     unsigned long nowMs = millis();
-    configureScanAggressive(nowMs);   // start awal dari aggressive
+    if (!startFastReconnect(&clientCallbacks)) {
+        configureScanAggressive(nowMs);   // start awal dari aggressive
+    }
+
+    // Yang tidak perlu untuk unlock dikerjakan setelah radio jalan
+    Serial.begin(115200);
+    Serial.println("=== ESP32-C3 SUPER MINI — iTAG CONTROL ===");
+    Serial.printf("[BOOT] reset=%s boot#%lu%s\n",
+                  resetReasonName(reason), (unsigned long)bootCache.bootCount,
+                  fastReconnectPending ? " → fast reconnect ke key terakhir" : "");
+
+    // Threshold baru dipakai setelah ~10 detik RSSI, jadi aman dimuat di sini
+    loadCalibration();
+
+#ifdef TelemetryGatt
+    setupTelemetry();
+#endif
+
+    pinMode(LED_BUILTIN, OUTPUT);
+    indicatorBegin();
 }
 
 void loop() {
     unsigned long nowMs = millis();
-    bool rssiUpdated = false;
 
     // heartbeat
     if (nowMs - lastHBMs >= 500) {
@@ -732,6 +2010,8 @@ void loop() {
     }
 
     // ===== logic tanpa BLE =====
+    handleDeadlineEvents(nowMs);
+
     int reading = digitalRead(CONTACT_TRIGGER);
 
     if (reading != lastPhysicalState) {
@@ -745,127 +2025,59 @@ void loop() {
             handleTriggerPress(nowMs);
         }
     }
-    
-    if (manual_mode && (nowMs - activationStartMs) > ACTIVATION_WINDOW_MS) {
-        manual_mode = false;
-        startManualCode(nowMs);
-    }
 
-    processDigitTimeout(nowMs);
+    updateIndicatorLed(nowMs);
 
-    if (contactActive) {
-        if (nowMs - contactOnStartMs >= contactDurationMs) {
-            contactActive = false;
-            digitalWrite(CONTACT_RELAY, LOW);
-            Serial.println("[CONTACT] OFF (timeout)");
-        }
+    if (!bootReportDone &&
+        (bootTiming.has(BOOT_UNLOCK) || nowMs >= BOOT_REPORT_MAX_MS)) {
+        reportBootTiming();
     }
 
-    updateIndicatorLed(nowMs);
+    if (nowMs - lastEnergyReportMs >= ENERGY_REPORT_MS) {
+        lastEnergyReportMs = nowMs;
+        reportEnergy(nowMs);
+    }
 
-    // ADAPTIVE SCAN: kalau sudah 30 detik di AGGRESSIVE tanpa BLE connect → SLOW
-    if (!bleConnected &&
-        currentScanMode == SCAN_MODE_AGGRESSIVE &&
-        lastAggressiveScanStartMs != 0)
-    {
-        unsigned long timer = nowMs - lastAggressiveScanStartMs;
+    saveCalibration(nowMs);
 
-        if (timer >= 30000UL) {
-            Serial.println("[SCAN] >30s tanpa BLE, switch ke SLOW scan");
-            configureScanSlow();
-        }
+#ifdef TelemetryGatt
+    updateTelemetry(nowMs);
+#endif
+
+#ifdef ALLOC_COUNTER
+    if (nowMs - lastAllocReportMs >= ALLOC_REPORT_MS) {
+        lastAllocReportMs = nowMs;
+        reportAllocations();
     }
+#endif
 
     // ===== logic yang butuh BLE connect =====
-    auto clients = NimBLEDevice::getConnectedClients();
-    if (clients.size() == 0) {
+    if (sessionCount == 0) {
         delay(5);
         return;
     }
 
-    NimBLEClient* client = clients[0];
-
-    if (!gButtonChar && !gBattChar) {
-        discoverServices(client);
-        delay(50);
-        return;
-    }
-
-    if (clickCount > 0 && (nowMs - lastClickMs > CLICK_WINDOW_MS)) {
-        uint8_t count = clickCount;
-        clickCount = 0;
-
-        if (count == 1) {
-            Serial.println("[ACTION] iTAG SINGLE CLICK → SEIN BLINK 2x");
-            for (int i = 0; i < 2; i++) {
-                digitalWrite(SEIN_RELAY, HIGH);
-                delay(120);
-                digitalWrite(SEIN_RELAY, LOW);
-                delay(120);
+    // Tiap sesi dikerjakan di salinan; slot bisa ditutup task NimBLE kapan saja
+    for (uint8_t i = 0; i < MAX_SESSIONS; ++i) {
+        Session ses;
+        if (!sessionSnapshot(i, ses)) continue;
+
+        if (!ses.discoveryTried) {
+            ses.discoveryTried = true;
+            discoverServices(i, ses);
+            if (sessionCommit(i, ses) && !ses.buttonChar && !ses.battChar) {
+                // Bukan iTAG yang bisa dipakai → lepas, slot bebas untuk key lain
+                Serial.printf("!! key #%d tanpa service iTAG/baterai → disconnect\n", ses.keyIndex);
+                ses.client->disconnect();
             }
-        } else {
-            Serial.printf("[ACTION] iTAG MULTI (%u) → HORN BLINK 2x\n", count);
-            digitalWrite(HORN_RELAY, HIGH);
-            delay(300);
-            digitalWrite(HORN_RELAY, LOW);
-            delay(200);
-            digitalWrite(HORN_RELAY, HIGH);
-            delay(300);
-            digitalWrite(HORN_RELAY, LOW);
+            continue;
         }
-    }
 
-    if (nowMs - lastRssiUpdate >= 1000) {
-        lastRssiUpdate = nowMs;
-        int rssi = client->getRssi();
-        rssiUpdated = true;
-
-        const float alpha = 0.2f;
-        rssiAvg = alpha * rssi + (1.0f - alpha) * rssiAvg;
-
-        static const char* lastZone = nullptr;
-        const char* zone = classifyDistance(rssiAvg);
-        if (zone != lastZone) {
-            DBG("[DIST] RSSI avg=%.1f dBm → %s\n", rssiAvg, zone);
-            lastZone = zone;
-        }
+        updateSessionRssi(ses, nowMs);
+        sessionCommit(i, ses);
     }
 
-    if (!isNear && rssiAvg >= RSSI_NEAR_THRESHOLD) {
-        isNear = true;
-        nearFalseCount = 0;
-        Serial.println("[DIST] <2m → NEAR = true");
-    } else if (isNear && rssiAvg <= RSSI_FAR_THRESHOLD) {
-        isNear = false;
-        Serial.println("[DIST] >2m → NEAR = false");
-    }
-
-    if (rssiUpdated) {
-        if (!isNear) {
-            if (nearFalseCount < 5) {
-                nearFalseCount++;
-            }
-            if (nearFalseCount == 5 && sessionHadContact) {
-                sessionHadContact = false;
-                Serial.println("[DIST] FAR → sessionHadContact reset");
-            }
-        } else {
-            nearFalseCount = 0;
-        }
-    }
-
-    if (bleConnected && gBattChar && (nowMs - lastBattPollMs >= BATTERY_POLL_MS)) {
-        lastBattPollMs = nowMs;
-        std::string val = gBattChar->readValue();
-        if (!val.empty()) {
-            uint8_t level = (uint8_t)val[0];
-            batteryPercent = level;
-            batteryLow     = (level < 20);
-#ifdef ReadMessage
-            Serial.printf("[BATT-POLL] level=%u%%  low=%d\n", level, batteryLow);
-#endif
-        }
-    }
+    selectNearestKey();
 
     delay(5);
 }
@@ -0,0 +1,79 @@
+// ======================================================================
+//  HOST DECODER DUMP BINER ScanForGetMac (ScanDumpBinary)
+//  Baca stream serial mentah dari stdin, cari frame "ADVT", cek CRC,
+//  lalu cetak tabel device. Byte di luar frame (log teks) di-skip.
+//
+//  Build (dari root repo):
+//    g++ -std=c++17 -O2 -Ilib/AdvTable tools/adv_dump/adv_dump.cpp
+//        lib/AdvTable/AdvTable.cpp -o adv_dump
+//  Pakai:
+//    stty -F /dev/ttyACM0 115200 raw && ./adv_dump < /dev/ttyACM0
+// ======================================================================
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "AdvTable.h"
+
+static void printRecord(const AdvEntry& e, void*) {
+    printf("%02x:%02x:%02x:%02x:%02x:%02x/%u %6u %4d %4d %4d  %-20.*s",
+           e.addr[5], e.addr[4], e.addr[3], e.addr[2], e.addr[1], e.addr[0], e.addrType,
+           e.count, e.rssiMin, e.rssiMean(), e.rssiMax,
+           (int)e.nameLen, e.name);
+
+    for (uint8_t u = 0; u < e.uuidCount; ++u) {
+        printf(u ? "," : " svc=");
+        for (int b = e.uuids[u].len - 1; b >= 0; --b) printf("%02x", e.uuids[u].val[b]);
+    }
+    if (e.mfgLen) {
+        printf(" mfg=");
+        for (uint8_t b = 0; b < e.mfgLen; ++b) printf("%02X", e.mfg[b]);
+    }
+    printf("\n");
+}
+
+int main() {
+    std::vector<uint8_t> buf;
+    uint8_t chunk[512];
+    size_t  n;
+    unsigned frames = 0, crcErrors = 0;
+
+    while ((n = fread(chunk, 1, sizeof(chunk), stdin)) > 0) {
+        buf.insert(buf.end(), chunk, chunk + n);
+
+        size_t pos = 0;
+        while (pos + 4 <= buf.size()) {
+            if (memcmp(&buf[pos], "ADVT", 4) != 0) {
+                ++pos;
+                continue;
+            }
+
+            AdvFrameHeader hdr;
+            size_t frameLen = 0;
+            const size_t avail = buf.size() - pos;
+
+            // decode dua kali: pertama validasi, kedua cetak (cuma kalau valid)
+            if (advDecodeFrame(&buf[pos], avail, hdr, &frameLen, nullptr, nullptr)) {
+                ++frames;
+                printf("\n=== frame #%u: %u device, %.0f adv/s diproses ===\n",
+                       frames, hdr.count,
+                       hdr.windowMs ? hdr.processed * 1000.0 / hdr.windowMs : 0.0);
+                printf("    dibuang: %u parse gagal, %u tabel penuh | scan restart %u | "
+                       "%u device diganti (bukan advert hilang)\n",
+                       hdr.parseErrors, hdr.tableFull, hdr.scanRestarts, hdr.evicted);
+                printf("%-20s %6s %4s %4s %4s  %s\n", "address/type", "count", "min", "avg", "max", "name");
+                advDecodeFrame(&buf[pos], avail, hdr, &frameLen, printRecord, nullptr);
+                fflush(stdout);
+                pos += frameLen;
+            } else if (avail >= ADV_DUMP_FRAME_MAX) {
+                ++crcErrors;   // cukup data tapi tetap invalid → bukan frame
+                ++pos;
+            } else {
+                break;         // tunggu data berikutnya
+            }
+        }
+        buf.erase(buf.begin(), buf.begin() + pos);
+    }
+
+    fprintf(stderr, "%u frame valid, %u kandidat invalid\n", frames, crcErrors);
+    return 0;
+}
@@ -0,0 +1,130 @@
+// ======================================================================
+//  HOST ALLOC CHECK
+//  Library yang dipanggil jalur steady state firmware (lib/NotifyRoutes,
+//  lib/Telemetry encode + coalesce, lib/RssiCalib) dijalankan N iterasi
+//  dengan lib/AllocCounter ikut di-link. operator new global diganti, jadi
+//  alokasi apa pun di library itu membuat allocCounterCount() berubah.
+//
+//  Yang TIDAK dicek di sini: kode firmware di sekitarnya (notifyCallback,
+//  pollBattery / ble_gattc_read, loop, Serial, NimBLE). PASS berarti
+//  library ini tidak alokasi, bukan firmware nol alokasi; itu dicek di
+//  perangkat dengan env *-alloccheck (reportAllocations, di luar scan).
+//
+//  Build (dari root repo):
+//    g++ -std=c++17 -O2 -Ilib/AllocCounter -Ilib/NotifyRoutes -Ilib/Telemetry
+//        -Ilib/RssiCalib tools/alloc_check/alloc_check.cpp
+//        lib/AllocCounter/AllocCounter.cpp lib/NotifyRoutes/NotifyRoutes.cpp
+//        lib/Telemetry/Telemetry.cpp lib/RssiCalib/RssiCalib.cpp -o alloc_check
+//  Pakai:
+//    ./alloc_check           → 100000 iterasi, PASS/FAIL
+//    ./alloc_check 1000000   → jumlah iterasi sendiri
+// ======================================================================
+#include <cstdio>
+#include <cstdlib>
+#include "AllocCounter.h"
+#include "NotifyRoutes.h"
+#include "Telemetry.h"
+#include "RssiCalib.h"
+
+// Sama dengan firmware (src/main.cpp)
+static const uint8_t  MAX_SESSIONS    = 3;
+static const uint16_t STATUS_MIN_MS   = 200;
+static const uint16_t COUNTERS_MIN_MS = 1000;
+static const uint16_t HEARTBEAT_MS    = 5000;
+static const uint32_t LOOP_MS         = 5;
+
+static NotifyRouteTable   routes;
+static TelemetryCoalescer statusCo, countersCo;
+static RssiCalib          calib;
+
+// Cegah optimizer membuang hasil
+static volatile uint32_t sink = 0;
+
+// Setup: semua yang boleh alokasi terjadi di sini, sebelum baseline.
+static void setupState() {
+    for (uint8_t s = 0; s < MAX_SESSIONS; ++s) {
+        uint16_t conn = (uint16_t)(s + 1);
+        routes.add(conn, 0x0010, s, NOTIFY_BUTTON);
+        routes.add(conn, 0x0020, s, NOTIFY_BATTERY);
+    }
+    statusCo.begin(STATUS_MIN_MS, HEARTBEAT_MS, TELEMETRY_STATUS_LEN);
+    countersCo.begin(COUNTERS_MIN_MS, HEARTBEAT_MS, TELEMETRY_COUNTERS_CMP);
+    calib.begin(-71, -72);
+}
+
+static void step(uint32_t i) {
+    uint32_t nowMs = i * LOOP_MS;
+    uint8_t  s     = (uint8_t)(i % MAX_SESSIONS);
+    uint16_t conn  = (uint16_t)(s + 1);
+
+    // notifyCallback: lookup route tombol / baterai + discovery ulang (dedupe)
+    const NotifyRoute* r = routes.find(conn, (i & 1) ? 0x0020 : 0x0010);
+    if (r) sink = sink + r->session + r->kind;
+    if (i % 97 == 0) routes.add(conn, 0x0010, s, NOTIFY_BUTTON);
+
+    // updateTelemetry()
+    TelemetryStatus st = {};
+    st.flags          = TELEMETRY_F_CONNECTED | ((i / 400) & 1 ? TELEMETRY_F_NEAR : 0);
+    st.rssiAvg        = (int8_t)(-60 - (int)(i % 30));
+    st.nearDbm        = calib.thresholds(s).nearDbm;
+    st.farDbm         = calib.thresholds(s).farDbm;
+    st.batteryPercent = 87;
+    st.sessionCount   = MAX_SESSIONS;
+    st.nearestKey     = (int8_t)s;
+
+    TelemetryCounters ct = {};
+    ct.unlocks  = (uint16_t)(i / 1000);
+    ct.notifies = i;
+    ct.uptimeS  = nowMs / 1000;
+
+    uint8_t buf[TELEMETRY_MAX_LEN];
+    size_t  len = telemetryEncodeStatus(st, buf);
+    if (statusCo.offer(nowMs, buf, (uint8_t)len)) sink = sink + 1;
+    len = telemetryEncodeCounters(ct, buf);
+    if (countersCo.offer(nowMs, buf, (uint8_t)len)) sink = sink + 1;
+
+    // Kalibrasi: unlock / far jarang, recompute + record NVS tiap kali
+    if (i % 50 == 0)  calib.noteUnlock(s, -58.0f - (float)(i % 11));
+    if (i % 170 == 0) calib.noteFar(s, -88.0f - (float)(i % 7));
+    if (i % 1000 == 0 && calib.dirty(s)) {
+        RssiCalibRecord rec;
+        calib.record(s, rec);
+        sink = sink + rec.nearHist.total;
+    }
+
+    // Disconnect/reconnect sesekali (bukan steady state di firmware, tapi
+    // tabel tetap tidak boleh alokasi)
+    if (i % 5000 == 4999) {
+        routes.removeSession(s);
+        routes.add(conn, 0x0010, s, NOTIFY_BUTTON);
+        routes.add(conn, 0x0020, s, NOTIFY_BATTERY);
+    }
+}
+
+int main(int argc, char** argv) {
+    uint32_t iterations = argc > 1 ? (uint32_t)strtoul(argv[1], nullptr, 10) : 100000;
+
+    setupState();
+
+    uint32_t count0 = allocCounterCount();
+    uint32_t bytes0 = allocCounterBytes();
+    for (uint32_t i = 0; i < iterations; ++i) step(i);
+    uint32_t dCount = allocCounterCount() - count0;
+    uint32_t dBytes = allocCounterBytes() - bytes0;
+
+    printf("%u iterasi, route %u/%u, alokasi %u (%u B)\n",
+           iterations, routes.count(), NOTIFY_ROUTE_CAPACITY, dCount, dBytes);
+
+    // Sanity: counter memang aktif di build ini
+    // (operator new langsung: pasangan new/delete boleh dibuang compiler)
+    void* probe = ::operator new(16);
+    bool counterLive = allocCounterCount() != count0 + dCount;
+    ::operator delete(probe);
+    if (!counterLive) {
+        printf("FAIL (AllocCounter tidak ikut di-link)\n");
+        return 1;
+    }
+
+    printf("%s\n", dCount ? "FAIL" : "PASS");
+    return dCount ? 1 : 0;
+}
@@ -0,0 +1,182 @@
+// ======================================================================
+//  HOST TEST DEADLINE WHEEL
+//  Jalankan lib/DeadlineWheel di atas VirtualDeadlineClock dan cek:
+//    - reschedule : deadline lama batal, fire sekali di waktu baru
+//    - cancel     : tidak fire, event bit hilang, hardware di-disarm
+//    - urutan     : deadline sama → urut id; beda → urut waktu
+//    - generation : slot yang di-schedule ulang callback lain di batch
+//                   yang sama tidak fire dobel
+//    - latency    : lastLateUs/maxLateUs sesuai setDispatchLatency()
+//
+//  Build (dari root repo):
+//    g++ -std=c++17 -O2 -Ilib/DeadlineWheel tools/deadline_test/deadline_test.cpp
+//        lib/DeadlineWheel/DeadlineWheel.cpp -o deadline_test
+//  Pakai:
+//    ./deadline_test    → PASS/FAIL per kasus
+// ======================================================================
+#include <cstdio>
+#include "DeadlineWheel.h"
+
+struct Fire {
+    uint8_t  id;
+    uint64_t atUs;
+};
+
+static DeadlineWheel        wheel;
+static VirtualDeadlineClock vclock;
+static Fire                 fires[64];
+static int                  fireCount = 0;
+static int                  fails     = 0;
+
+static void record(uint8_t id, void*) {
+    if (fireCount < 64) fires[fireCount++] = Fire{ id, wheel.nowUs() };
+}
+
+static void reset() {
+    vclock = VirtualDeadlineClock{};
+    wheel  = DeadlineWheel{};
+    vclock.attach(&wheel);
+    wheel.begin(&vclock);
+    for (uint8_t i = 0; i < DEADLINE_MAX_TIMERS; ++i) wheel.setCallback(i, record);
+    fireCount = 0;
+}
+
+static void expect(bool ok, const char* name, const char* what) {
+    if (ok) return;
+    printf("  FAIL %s: %s\n", name, what);
+    ++fails;
+}
+
+static void testReschedule() {
+    const char* name = "reschedule";
+    reset();
+    wheel.scheduleAt(3, 1000);
+    wheel.scheduleAt(3, 5000);   // mundur
+    vclock.advance(2000);
+    expect(fireCount == 0, name, "deadline lama masih fire");
+    expect(wheel.pending(3), name, "slot tidak pending setelah reschedule");
+    expect(vclock.armedAt() == 5000, name, "hardware tidak di-arm ke deadline baru");
+    vclock.advance(4000);
+    expect(fireCount == 1 && fires[0].id == 3 && fires[0].atUs == 5000, name,
+           "tidak fire tepat sekali di 5000 us");
+    expect(wheel.takeEvents() == deadlineBit(3), name, "event bit salah");
+
+    // Maju: deadline lebih awal dari yang sedang di-arm
+    reset();
+    wheel.scheduleAt(1, 9000);
+    wheel.scheduleAt(1, 2000);
+    vclock.advance(10000);
+    expect(fireCount == 1 && fires[0].atUs == 2000, name, "reschedule maju tidak dipakai");
+
+    // Event yang belum diambil ikut batal saat reschedule
+    reset();
+    wheel.scheduleAt(2, 100);
+    vclock.advance(200);
+    wheel.scheduleAt(2, 1000);
+    expect(wheel.takeEvents() == 0, name, "event lama tidak dibatalkan reschedule");
+}
+
+static void testCancel() {
+    const char* name = "cancel";
+    reset();
+    wheel.scheduleAt(4, 1000);
+    wheel.cancel(4);
+    expect(!vclock.armed(), name, "hardware masih di-arm tanpa deadline");
+    vclock.advance(5000);
+    expect(fireCount == 0, name, "slot yang di-cancel fire");
+    expect(wheel.takeEvents() == 0, name, "event bit muncul setelah cancel");
+
+    // Cancel satu dari dua: yang lain tetap jalan, hardware pindah
+    reset();
+    wheel.scheduleAt(5, 1000);
+    wheel.scheduleAt(6, 3000);
+    wheel.cancel(5);
+    expect(vclock.armedAt() == 3000, name, "hardware tidak pindah ke deadline berikutnya");
+    vclock.advance(4000);
+    expect(fireCount == 1 && fires[0].id == 6, name, "slot lain ikut batal / salah fire");
+}
+
+static void testOrdering() {
+    const char* name = "urutan";
+    reset();
+    wheel.scheduleAt(9, 2000);
+    wheel.scheduleAt(2, 2000);
+    wheel.scheduleAt(7, 2000);
+    wheel.scheduleAt(0, 3000);
+    wheel.scheduleAt(5, 1000);
+    vclock.advance(5000);
+
+    const uint8_t  wantId[] = { 5, 2, 7, 9, 0 };
+    const uint64_t wantAt[] = { 1000, 2000, 2000, 2000, 3000 };
+    bool ok = fireCount == 5;
+    for (int i = 0; ok && i < 5; ++i) {
+        ok = fires[i].id == wantId[i] && fires[i].atUs == wantAt[i];
+    }
+    expect(ok, name, "urutan fire bukan (waktu, id)");
+    expect(wheel.takeEvents() ==
+               (deadlineBit(0) | deadlineBit(2) | deadlineBit(5) | deadlineBit(7) | deadlineBit(9)),
+           name, "event bit tidak lengkap");
+}
+
+// Slot 1 dan 2 expired bersamaan; callback 1 menjadwal ulang slot 2.
+static void rescheduleOther(uint8_t id, void*) {
+    record(id, nullptr);
+    wheel.scheduleIn(2, 1000);
+}
+
+static void testGeneration() {
+    const char* name = "generation";
+    reset();
+    wheel.setCallback(1, rescheduleOther);
+    wheel.scheduleAt(1, 1000);
+    wheel.scheduleAt(2, 1000);
+    vclock.advance(1500);
+    expect(fireCount == 1 && fires[0].id == 1, name, "callback slot 2 yang sudah basi tetap jalan");
+    expect(wheel.pending(2), name, "slot 2 tidak pending setelah dijadwal ulang");
+    vclock.advance(1000);
+    expect(fireCount == 2 && fires[1].id == 2 && fires[1].atUs == 2000, name,
+           "slot 2 tidak fire sekali di deadline baru");
+
+    // Callback menjadwal ulang dirinya sendiri (periodik)
+    reset();
+    wheel.setCallback(3, [](uint8_t id, void*) {
+        record(id, nullptr);
+        if (fireCount < 4) wheel.scheduleIn(id, 500);
+    });
+    wheel.scheduleAt(3, 500);
+    vclock.advance(10000);
+    expect(fireCount == 4 && fires[3].atUs == 2000, name, "reschedule dari callback sendiri salah");
+}
+
+static void testLatency() {
+    const char* name = "latency";
+    reset();
+    vclock.setDispatchLatency(250);
+    wheel.scheduleAt(8, 1000);
+    vclock.advance(2000);
+    expect(fireCount == 1 && fires[0].atUs == 1250, name, "dispatch tidak telat 250 us");
+    expect(wheel.lastLateUs(8) == 250 && wheel.maxLateUs(8) == 250, name, "lastLateUs/maxLateUs salah");
+
+    vclock.setDispatchLatency(40);
+    wheel.scheduleIn(8, 1000);
+    vclock.advance(2000);
+    expect(wheel.lastLateUs(8) == 40 && wheel.maxLateUs(8) == 250, name, "maxLateUs tidak menahan maksimum");
+}
+
+int main() {
+    struct { const char* name; void (*fn)(); } cases[] = {
+        { "reschedule", testReschedule },
+        { "cancel",     testCancel },
+        { "urutan",     testOrdering },
+        { "generation", testGeneration },
+        { "latency",    testLatency },
+    };
+
+    for (auto& c : cases) {
+        int before = fails;
+        c.fn();
+        printf("%-12s %s\n", c.name, fails == before ? "ok" : "GAGAL");
+    }
+    printf("%s (%d gagal)\n", fails ? "FAIL" : "PASS", fails);
+    return fails ? 1 : 0;
+}
@@ -0,0 +1,163 @@
+// ======================================================================
+//  HOST ENERGY MODEL
+//  Hitung mAh/hari dari deskripsi skenario pakai fungsi yang sama dengan
+//  firmware (lib/EnergyProfiler), jadi policy scan bisa dibandingkan
+//  sebelum di-flash.
+//
+//  Build (dari root repo):
+//    g++ -std=c++17 -O2 -Ilib/EnergyProfiler -Ilib/RelayDriver -Ilib/DeadlineWheel
+//        tools/energy_model/energy_model.cpp lib/EnergyProfiler/EnergyProfiler.cpp
+//        -o energy_model
+//  Pakai:
+//    ./energy_model tools/energy_model/scenarios/*.txt
+//
+//  Format skenario (satu perintah per baris, '#' = komentar):
+//    board        esp32c3-supermini | esp32-devkit-v1
+//    scan_active  <jam/hari> <interval_ms> <window_ms>
+//    scan_passive <jam/hari> <interval_ms> <window_ms>
+//    connected    <jam/hari>
+//    idle         <jam/hari>     (sisa sampai 24 jam otomatis masuk idle)
+//    advertise    <jam/hari> <interval_ms>   (paralel dengan state di atas)
+//    relay        contact|sein|horn <aktivasi/hari> <detik/aktivasi>
+//                 [pwm | <pull-in ms> <hold duty 0..1>]
+//                 tanpa argumen = full drive terus; "pwm" = PWM hold dengan
+//                 RELAY_PROFILES (lib/RelayDriver, sama dengan firmware);
+//                 angka = profil lain untuk dibandingkan
+// ======================================================================
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "EnergyProfiler.h"
+#include "RelayDriver.h"   // relayCoilWeight() + RELAY_PROFILES
+
+static const double MS_PER_HOUR = 3600.0 * 1000.0;
+
+struct Scenario {
+    const BoardCurrentTable* board = &ENERGY_BOARD_ESP32C3_SUPERMINI;
+    EnergyTotals totals = {};
+};
+
+static bool parseRelay(const char* name, EnergyRelay* out) {
+    if (strcmp(name, "contact") == 0) { *out = ENERGY_RELAY_CONTACT; return true; }
+    if (strcmp(name, "sein") == 0)    { *out = ENERGY_RELAY_SEIN;    return true; }
+    if (strcmp(name, "horn") == 0)    { *out = ENERGY_RELAY_HORN;    return true; }
+    return false;
+}
+
+static bool loadScenario(const char* path, Scenario& sc) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "!! tidak bisa buka %s\n", path);
+        return false;
+    }
+
+    char line[160];
+    int  lineNo = 0;
+    bool ok     = true;
+
+    while (fgets(line, sizeof(line), f)) {
+        ++lineNo;
+        char* hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+
+        char   cmd[32] = {0};
+        char   arg[32] = {0};
+        char   opt[32] = {0};
+        double hours = 0, a = 0, b = 0, pullInMs = 0, holdDuty = 1.0;
+        int    n = 0;
+
+        if (sscanf(line, "%31s", cmd) != 1) continue;
+
+        if (strcmp(cmd, "board") == 0 && sscanf(line, "%*s %31s", arg) == 1) {
+            if (strcmp(arg, ENERGY_BOARD_ESP32C3_SUPERMINI.name) == 0) {
+                sc.board = &ENERGY_BOARD_ESP32C3_SUPERMINI;
+            } else if (strcmp(arg, ENERGY_BOARD_ESP32_DEVKIT.name) == 0) {
+                sc.board = &ENERGY_BOARD_ESP32_DEVKIT;
+            } else {
+                fprintf(stderr, "%s:%d: board '%s' tidak dikenal\n", path, lineNo, arg);
+                ok = false;
+            }
+        } else if ((strcmp(cmd, "scan_active") == 0 || strcmp(cmd, "scan_passive") == 0) &&
+                   sscanf(line, "%*s %lf %lf %lf", &hours, &a, &b) == 3) {
+            EnergyRadioState s = (cmd[5] == 'a') ? ENERGY_SCAN_ACTIVE : ENERGY_SCAN_PASSIVE;
+            uint64_t ms = (uint64_t)(hours * MS_PER_HOUR);
+            sc.totals.stateMs[s] += ms;
+            sc.totals.scanRxMs   += (uint64_t)(ms * energyScanDuty((uint16_t)a, (uint16_t)b));
+        } else if (strcmp(cmd, "connected") == 0 && sscanf(line, "%*s %lf", &hours) == 1) {
+            sc.totals.stateMs[ENERGY_CONNECTED] += (uint64_t)(hours * MS_PER_HOUR);
+        } else if (strcmp(cmd, "advertise") == 0 && sscanf(line, "%*s %lf %lf", &hours, &a) == 2) {
+            uint64_t ms = (uint64_t)(hours * MS_PER_HOUR);
+            sc.totals.advMs   += ms;
+            sc.totals.advTxMs += (uint64_t)(ms * energyAdvDuty((uint16_t)a));
+        } else if (strcmp(cmd, "idle") == 0 && sscanf(line, "%*s %lf", &hours) == 1) {
+            sc.totals.stateMs[ENERGY_IDLE] += (uint64_t)(hours * MS_PER_HOUR);
+        } else if (strcmp(cmd, "relay") == 0 &&
+                   (n = sscanf(line, "%*s %31s %lf %lf %31s %lf", arg, &a, &b, opt, &holdDuty)) >= 3) {
+            EnergyRelay r;
+            if (!parseRelay(arg, &r)) {
+                fprintf(stderr, "%s:%d: relay '%s' tidak dikenal\n", path, lineNo, arg);
+                ok = false;
+                continue;
+            }
+            if (n == 4 && strcmp(opt, "pwm") == 0) {
+                pullInMs = RELAY_PROFILES[r].pullInMs;
+                holdDuty = RELAY_PROFILES[r].holdDuty;
+            } else if (n == 5) {
+                pullInMs = atof(opt);
+            } else if (n != 3) {
+                fprintf(stderr, "%s:%d: relay butuh 'pwm' atau <pull-in ms> <hold duty>\n",
+                        path, lineNo);
+                ok = false;
+                continue;
+            }
+            // Full drive selama pull-in, sisanya bobot d²
+            double onMs   = b * 1000.0;
+            double fullMs = pullInMs < onMs ? pullInMs : onMs;
+            double eqMs   = fullMs + (onMs - fullMs) * relayCoilWeight((float)holdDuty);
+            sc.totals.relayMs[r] += (uint64_t)(a * eqMs);
+        } else {
+            fprintf(stderr, "%s:%d: baris tidak valid\n", path, lineNo);
+            ok = false;
+        }
+    }
+    fclose(f);
+
+    uint64_t sum = 0;
+    for (uint8_t s = 0; s < ENERGY_RADIO_STATE_COUNT; ++s) sum += sc.totals.stateMs[s];
+
+    const uint64_t day = (uint64_t)(24.0 * MS_PER_HOUR);
+    if (sum > day) {
+        fprintf(stderr, "%s: total state %.2f jam > 24 jam\n", path, sum / MS_PER_HOUR);
+        return false;
+    }
+    sc.totals.stateMs[ENERGY_IDLE] += day - sum;
+    sc.totals.totalMs = day;
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s scenario.txt [scenario2.txt ...]\n", argv[0]);
+        return 2;
+    }
+
+    printf("%-32s %-18s %9s %9s %9s\n", "scenario", "board", "logic", "relay", "mAh/day");
+
+    int rc = 0;
+    for (int i = 1; i < argc; ++i) {
+        Scenario sc;
+        if (!loadScenario(argv[i], sc)) {
+            rc = 1;
+            continue;
+        }
+
+        float logicMah, relayMah;
+        energySplitMahPerDay(sc.totals, *sc.board, &logicMah, &relayMah);
+
+        const char* name = strrchr(argv[i], '/');
+        name = name ? name + 1 : argv[i];
+        printf("%-32s %-18s %9.1f %9.1f %9.1f\n",
+               name, sc.board->name, logicMah, relayMah, logicMah + relayMah);
+    }
+    return rc;
+}
@@ -0,0 +1,226 @@
+// ======================================================================
+//  HOST SIMULASI RELAY DRIVER
+//  Jalankan lib/RelayDriver di atas VirtualDeadlineClock dengan pola
+//  aktivasi yang sama dengan firmware (contact auto, sein blink, horn),
+//  rekam waveform duty per relay, lalu cek timing pull-in → hold → OFF.
+//
+//  Build (dari root repo):
+//    g++ -std=c++17 -O2 -Ilib/RelayDriver -Ilib/DeadlineWheel -Ilib/EnergyProfiler
+//        tools/relay_sim/relay_sim.cpp lib/RelayDriver/RelayDriver.cpp
+//        lib/DeadlineWheel/DeadlineWheel.cpp lib/EnergyProfiler/EnergyProfiler.cpp
+//        -o relay_sim
+//  Pakai:
+//    ./relay_sim            → ringkasan + PASS/FAIL (exit 1 kalau ada FAIL)
+//    ./relay_sim -v         → plus waveform tiap skenario
+// ======================================================================
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "DeadlineWheel.h"
+#include "EnergyProfiler.h"
+#include "RelayDriver.h"
+
+static const uint8_t TIMER_CONTACT_OFF = 0;
+static const uint8_t TIMER_RELAY_HOLD  = 1;
+
+struct Edge {
+    uint64_t atUs;
+    uint8_t  relay;
+    uint16_t duty;
+};
+
+class RecordingOutput : public RelayOutput {
+public:
+    explicit RecordingOutput(VirtualDeadlineClock& clock) : clock_(clock) {}
+    void write(uint8_t relay, uint16_t duty) override {
+        edges.push_back(Edge{ clock_.nowUs(), relay, duty });
+    }
+    std::vector<Edge> edges;
+
+private:
+    VirtualDeadlineClock& clock_;
+};
+
+// Satu aktivasi yang diharapkan: ON di onMs, OFF di offMs.
+struct Pulse {
+    uint8_t  relay;
+    uint32_t onMs;
+    uint32_t offMs;
+    bool     offByDeadline;   // OFF lewat TIMER_CONTACT_OFF (ikut telat dispatch)
+};
+
+struct Sim {
+    VirtualDeadlineClock clock;
+    DeadlineWheel        wheel;
+    RecordingOutput      out{clock};
+    RelayDriver          relays;
+
+    void begin(uint32_t latencyUs) {
+        clock.attach(&wheel);
+        clock.setDispatchLatency(latencyUs);
+        wheel.begin(&clock);
+        wheel.setCallback(TIMER_CONTACT_OFF, [](uint8_t, void* arg) {
+            static_cast<RelayDriver*>(arg)->off(ENERGY_RELAY_CONTACT);
+        }, &relays);
+        relays.begin(&out, &wheel, TIMER_RELAY_HOLD, ENERGY_RELAY_COUNT);
+        for (uint8_t r = 0; r < ENERGY_RELAY_COUNT; ++r) relays.setProfile(r, RELAY_PROFILES[r]);
+        out.edges.clear();
+    }
+
+    void advanceTo(uint32_t ms) {
+        uint64_t at = (uint64_t)ms * 1000ULL;
+        if (at > clock.nowUs()) clock.advance(at - clock.nowUs());
+    }
+};
+
+static const char* RELAY_NAMES[ENERGY_RELAY_COUNT] = { "CONTACT", "SEIN", "HORN" };
+
+// Jalankan pulsa berurutan waktu; OFF biasa dipanggil seperti loop().
+static void runPulses(Sim& sim, const std::vector<Pulse>& pulses) {
+    struct Action { uint32_t ms; const Pulse* p; bool on; };
+    std::vector<Action> acts;
+    for (const Pulse& p : pulses) {
+        acts.push_back(Action{ p.onMs, &p, true });
+        if (!p.offByDeadline) acts.push_back(Action{ p.offMs, &p, false });
+    }
+    // insertion sort, urutan stabil (OFF sebelum ON di ms yang sama kalau ditulis begitu)
+    for (size_t i = 1; i < acts.size(); ++i) {
+        for (size_t j = i; j > 0 && acts[j].ms < acts[j - 1].ms; --j) {
+            Action t = acts[j]; acts[j] = acts[j - 1]; acts[j - 1] = t;
+        }
+    }
+
+    uint32_t endMs = 0;
+    for (const Action& a : acts) {
+        sim.advanceTo(a.ms);
+        if (a.on) {
+            sim.relays.on(a.p->relay);
+            if (a.p->offByDeadline) {
+                sim.wheel.scheduleIn(TIMER_CONTACT_OFF, (uint64_t)(a.p->offMs - a.p->onMs) * 1000ULL);
+            }
+        } else {
+            sim.relays.off(a.p->relay);
+        }
+        if (a.p->offMs > endMs) endMs = a.p->offMs;
+    }
+    sim.advanceTo(endMs + 200);
+}
+
+static bool near(uint64_t atUs, uint64_t expectUs, uint32_t latencyUs) {
+    return atUs >= expectUs && atUs <= expectUs + latencyUs;
+}
+
+// Cek edge satu relay terhadap daftar pulsa.
+static int checkRelay(const Sim& sim, uint8_t relay, const std::vector<Pulse>& pulses,
+                      uint32_t latencyUs, const char* scenario)
+{
+    std::vector<Edge> ev;
+    for (const Edge& e : sim.out.edges) {
+        if (e.relay == relay) ev.push_back(e);
+    }
+
+    const RelayProfile& p = RELAY_PROFILES[relay];
+    const uint16_t holdDuty = (uint16_t)(p.holdDuty * RELAY_PWM_MAX + 0.5f);
+    int    fails = 0;
+    size_t i     = 0;
+
+    auto fail = [&](const char* what, uint32_t onMs) {
+        printf("  FAIL %-12s %-7s pulsa @%u ms: %s\n", scenario, RELAY_NAMES[relay], onMs, what);
+        ++fails;
+    };
+
+    for (const Pulse& pl : pulses) {
+        if (pl.relay != relay) continue;
+        uint64_t onUs  = (uint64_t)pl.onMs * 1000ULL;
+        uint64_t offUs = (uint64_t)pl.offMs * 1000ULL;
+        uint32_t offLat = pl.offByDeadline ? latencyUs : 0;
+
+        if (i >= ev.size() || ev[i].atUs != onUs || ev[i].duty != RELAY_PWM_MAX) {
+            fail("tidak mulai dengan full pull-in", pl.onMs);
+            return fails;
+        }
+        ++i;
+
+        uint64_t holdUs = onUs + (uint64_t)p.pullInMs * 1000ULL;
+        if (holdUs < offUs) {
+            if (i >= ev.size() || !near(ev[i].atUs, holdUs, latencyUs) || ev[i].duty != holdDuty) {
+                fail("transisi ke hold salah waktu/duty", pl.onMs);
+                return fails;
+            }
+            ++i;
+        }
+
+        if (i >= ev.size() || !near(ev[i].atUs, offUs, offLat) || ev[i].duty != 0) {
+            fail("OFF salah waktu / ada edge ekstra", pl.onMs);
+            return fails;
+        }
+        ++i;
+    }
+
+    if (i != ev.size()) fail("edge ekstra setelah pulsa terakhir", 0);
+    return fails;
+}
+
+static void printWaveform(const Sim& sim) {
+    for (const Edge& e : sim.out.edges) {
+        printf("    %10.3f ms  %-7s duty %4u/%u\n",
+               e.atUs / 1000.0, RELAY_NAMES[e.relay], e.duty, RELAY_PWM_MAX);
+    }
+}
+
+int main(int argc, char** argv) {
+    bool verbose = argc > 1 && strcmp(argv[1], "-v") == 0;
+
+    struct Scenario {
+        const char*        name;
+        std::vector<Pulse> pulses;
+    };
+
+    // Pola aktivasi firmware (handleTriggerPress / handleClickAction)
+    std::vector<Scenario> scenarios = {
+        { "contact-auto",   { { ENERGY_RELAY_CONTACT, 0, 3000, true } } },
+        { "contact-manual", { { ENERGY_RELAY_CONTACT, 0, 7000, true } } },
+        { "sein-2x",        { { ENERGY_RELAY_SEIN, 0, 120, false },
+                              { ENERGY_RELAY_SEIN, 240, 360, false } } },
+        { "horn-2x",        { { ENERGY_RELAY_HORN, 0, 300, false },
+                              { ENERGY_RELAY_HORN, 500, 800, false } } },
+        // OFF di tengah pull-in lalu ON lagi: deadline hold lama tidak boleh
+        // memotong pull-in baru
+        { "retrigger",      { { ENERGY_RELAY_SEIN, 0, 20, false },
+                              { ENERGY_RELAY_SEIN, 30, 200, false } } },
+        { "bersamaan",      { { ENERGY_RELAY_CONTACT, 0, 3000, true },
+                              { ENERGY_RELAY_SEIN, 10, 130, false },
+                              { ENERGY_RELAY_HORN, 20, 320, false } } },
+    };
+
+    const uint32_t latencies[] = { 0, 500 };
+    const BoardCurrentTable& board = ENERGY_BOARD_ESP32C3_SUPERMINI;
+    int fails = 0;
+
+    printf("%-16s %8s %10s %10s %7s\n", "skenario", "lat(us)", "full mAh", "pwm mAh", "hemat");
+    for (const Scenario& sc : scenarios) {
+        for (uint32_t lat : latencies) {
+            Sim sim;
+            sim.begin(lat);
+            runPulses(sim, sc.pulses);
+
+            for (uint8_t r = 0; r < ENERGY_RELAY_COUNT; ++r) {
+                fails += checkRelay(sim, r, sc.pulses, lat, sc.name);
+            }
+
+            double fullMah = 0.0, pwmMah = 0.0;
+            for (uint8_t r = 0; r < ENERGY_RELAY_COUNT; ++r) {
+                RelayStats st;
+                sim.relays.stats(r, st);
+                fullMah += board.relayCoilMa[r] * st.onUs / 3.6e9;
+                pwmMah  += board.relayCoilMa[r] * st.driveUs / 3.6e9;
+            }
+            printf("%-16s %8u %10.4f %10.4f %6.0f%%\n", sc.name, lat, fullMah, pwmMah,
+                   fullMah > 0 ? 100.0 * (fullMah - pwmMah) / fullMah : 0.0);
+            if (verbose) printWaveform(sim);
+        }
+    }
+
+    printf("%s (%d gagal)\n", fails ? "FAIL" : "PASS", fails);
+    return fails ? 1 : 0;
+}
@@ -0,0 +1,193 @@
+// ======================================================================
+//  HOST EVAL KALIBRASI RSSI
+//  Replay trace RSSI (firmware dengan #define LogRssiTrace) lewat
+//  lib/RssiCalib yang sama dengan firmware, lalu bandingkan false-unlock
+//  dan missed-unlock antara threshold default dan hasil kalibrasi.
+//
+//  Build (dari root repo):
+//    g++ -std=c++17 -O2 -Ilib/RssiCalib tools/rssi_calib_eval/rssi_calib_eval.cpp
+//        lib/RssiCalib/RssiCalib.cpp -o rssi_calib_eval
+//  Pakai:
+//    grep TRACE monitor.log > motor1.csv   (isi kolom truth dulu, lihat bawah)
+//    ./rssi_calib_eval motor1.csv [motor2.csv ...]
+//    ./rssi_calib_eval tools/rssi_calib_eval/sample_trace.csv   (contoh berlabel)
+//
+//  Format CSV (prefix "[TRACE] " boleh ada, '#' = komentar):
+//    ms,key,rssi,truth,event
+//      rssi  : RSSI rata-rata (EMA) sesi, dBm
+//      truth : N = key memang dekat motor, F = jauh, ? = tidak tahu
+//              (firmware selalu tulis '?', diisi dari catatan waktu ambil data)
+//      event : S = sampel periodik,
+//              P / U = trigger ditekan saat connect (U = waktu itu unlock;
+//                      saat replay keduanya dinilai ulang dari state NEAR
+//                      policy, jadi dianggap sama),
+//              K = klik tombol iTAG (konfirmasi trigger yang ditahan),
+//              I = sampel far "parkir" (idle, bukan tepi jangkauan),
+//              F = putus karena supervision timeout
+//
+//  Metrik:
+//    missed-unlock : trigger truth=N saat state NEAR = false, plus sampel
+//                    truth=N yang tidak NEAR
+//    false-unlock  : trigger truth=F yang unlock (orang lain di motor saat
+//                    key pemilik connect dari jauh), plus sampel truth=F
+//                    yang NEAR
+//  Policy: default (-71/-72), online (belajar sambil jalan dengan aturan
+//  firmware: sampel near hanya dari trigger yang unlock atau dikonfirmasi
+//  klik K), final (threshold akhir dipakai dari awal; optimistis).
+// ======================================================================
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "RssiCalib.h"
+
+static const int8_t DEFAULT_NEAR = -71;
+static const int8_t DEFAULT_FAR  = -72;
+
+struct TraceRow {
+    unsigned long ms;
+    int           key;
+    float         rssi;
+    char          truth;
+    char          event;
+};
+
+struct EvalResult {
+    unsigned unlocks       = 0;
+    unsigned unlockMissed  = 0;
+    unsigned spoofPresses  = 0;
+    unsigned spoofUnlocked = 0;
+    unsigned nearSamples   = 0;
+    unsigned nearMissed    = 0;
+    unsigned farSamples    = 0;
+    unsigned farFalseNear  = 0;
+};
+
+enum Policy { POLICY_DEFAULT, POLICY_ONLINE, POLICY_FINAL };
+
+static bool loadTrace(const char* path, std::vector<TraceRow>& rows) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "!! tidak bisa buka %s\n", path);
+        return false;
+    }
+
+    char line[160];
+    int  lineNo = 0;
+    while (fgets(line, sizeof(line), f)) {
+        ++lineNo;
+        char* hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+
+        char* p = strstr(line, "[TRACE]");
+        p = p ? p + 7 : line;
+
+        TraceRow r;
+        if (sscanf(p, " %lu,%d,%f,%c,%c", &r.ms, &r.key, &r.rssi, &r.truth, &r.event) != 5) {
+            continue;   // baris kosong / log lain / header
+        }
+        if (r.key < 0 || r.key >= RSSI_CALIB_MAX_KEYS) {
+            fprintf(stderr, "!! %s:%d key %d di luar 0..%d\n", path, lineNo, r.key,
+                    RSSI_CALIB_MAX_KEYS - 1);
+            continue;
+        }
+        rows.push_back(r);
+    }
+    fclose(f);
+    return true;
+}
+
+static EvalResult replay(const std::vector<TraceRow>& rows, Policy policy, RssiCalib& calib) {
+    EvalResult res;
+    bool near[RSSI_CALIB_MAX_KEYS] = {};
+
+    for (const TraceRow& r : rows) {
+        RssiThresholds th = { DEFAULT_NEAR, DEFAULT_FAR, false };
+        if (policy != POLICY_DEFAULT) th = calib.thresholds((uint8_t)r.key);
+
+        if (r.event == 'S') {
+            // sama dengan updateSessionRssi() di firmware
+            if (!near[r.key] && r.rssi >= th.nearDbm)      near[r.key] = true;
+            else if (near[r.key] && r.rssi <= th.farDbm)   near[r.key] = false;
+
+            if (r.truth == 'N') {
+                res.nearSamples++;
+                if (!near[r.key]) res.nearMissed++;
+            } else if (r.truth == 'F') {
+                res.farSamples++;
+                if (near[r.key]) res.farFalseNear++;
+            }
+        } else if (r.event == 'P' || r.event == 'U') {
+            // sama dengan handleTriggerPress(): unlock kalau state NEAR
+            bool unlocked = near[r.key];
+            if (r.truth == 'F') {
+                res.spoofPresses++;
+                if (unlocked) res.spoofUnlocked++;
+            } else {
+                res.unlocks++;
+                if (!unlocked) res.unlockMissed++;
+            }
+            if (policy == POLICY_ONLINE) {
+                calib.notePress((uint8_t)r.key, (uint32_t)r.ms, r.rssi, unlocked);
+            }
+        } else if (r.event == 'K') {
+            if (policy == POLICY_ONLINE) calib.noteClick((uint8_t)r.key, (uint32_t)r.ms);
+        } else if (r.event == 'I') {
+            if (policy == POLICY_ONLINE) calib.noteFar((uint8_t)r.key, r.rssi);
+        } else if (r.event == 'F') {
+            near[r.key] = false;   // link putus
+            if (policy == POLICY_ONLINE) calib.noteFar((uint8_t)r.key, r.rssi);
+        }
+    }
+    return res;
+}
+
+static double pct(unsigned n, unsigned d) {
+    return d ? 100.0 * (double)n / (double)d : 0.0;
+}
+
+static void printResult(const char* name, const EvalResult& r) {
+    printf("  %-8s missed-unlock %5.1f%% (%u/%u trigger, %5.1f%% sampel N)  "
+           "false-unlock %5.1f%% (%u/%u trigger, %5.1f%% sampel F)\n",
+           name,
+           pct(r.unlockMissed, r.unlocks), r.unlockMissed, r.unlocks,
+           pct(r.nearMissed, r.nearSamples),
+           pct(r.spoofUnlocked, r.spoofPresses), r.spoofUnlocked, r.spoofPresses,
+           pct(r.farFalseNear, r.farSamples));
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "pakai: %s trace.csv [...]\n", argv[0]);
+        return 1;
+    }
+
+    int rc = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::vector<TraceRow> rows;
+        if (!loadTrace(argv[i], rows)) {
+            rc = 1;
+            continue;
+        }
+
+        printf("== %s (%zu baris)\n", argv[i], rows.size());
+
+        RssiCalib calib;
+        calib.begin(DEFAULT_NEAR, DEFAULT_FAR);
+        printResult("default", replay(rows, POLICY_DEFAULT, calib));
+        printResult("online", replay(rows, POLICY_ONLINE, calib));
+
+        // calib sekarang berisi histogram seluruh trace
+        printResult("final", replay(rows, POLICY_FINAL, calib));
+
+        for (uint8_t k = 0; k < RSSI_CALIB_MAX_KEYS; ++k) {
+            const RssiThresholds& th = calib.thresholds(k);
+            uint16_t nNear = calib.nearHist(k).total;
+            uint16_t nFar  = calib.farHist(k).total;
+            if (nNear == 0 && nFar == 0) continue;
+            printf("  key #%u near>=%d far<=%d (%u unlock, %u far)%s\n",
+                   k, th.nearDbm, th.farDbm, nNear, nFar,
+                   th.calibrated ? "" : " default");
+        }
+    }
+    return rc;
+}
@@ -0,0 +1,88 @@
+// ======================================================================
+//  HOST TELEMETRY DECODER
+//  Decode value characteristic telemetry (lib/Telemetry) yang disalin
+//  dari aplikasi BLE (nRF Connect dsb.) atau log, satu record per baris.
+//
+//  Build (dari root repo):
+//    g++ -std=c++17 -O2 -Ilib/Telemetry tools/telemetry_decode/telemetry_decode.cpp
+//        lib/Telemetry/Telemetry.cpp -o telemetry_decode
+//  Pakai:
+//    ./telemetry_decode 0x01-02-07-BA-B9-B8-5A-01-00-00-00
+//    ./telemetry_decode < dump.txt
+//
+//  Hex boleh dipisah spasi, '-', ':' atau ','; prefix "0x" diabaikan.
+// ======================================================================
+#include <cstdio>
+#include <cstring>
+#include <cctype>
+#include "Telemetry.h"
+#include "telemetry_print.h"
+
+static int hexVal(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    c = (char)tolower((unsigned char)c);
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+// Ambil byte hex dari teks; pemisah apa saja di antara pasangan digit.
+static size_t parseHex(const char* text, uint8_t* out, size_t cap) {
+    size_t n  = 0;
+    int    hi = -1;
+    for (const char* p = text; *p && n < cap; ++p) {
+        if (p[0] == '0' && (p[1] == 'x' || p[1] == 'X') && hi < 0) {
+            ++p;
+            continue;
+        }
+        int v = hexVal(*p);
+        if (v < 0) {
+            hi = -1;   // pemisah: digit tunggal sebelum ini dibuang
+            continue;
+        }
+        if (hi < 0) {
+            hi = v;
+        } else {
+            out[n++] = (uint8_t)((hi << 4) | v);
+            hi = -1;
+        }
+    }
+    return n;
+}
+
+static bool decodeLine(const char* text) {
+    uint8_t buf[64];
+    size_t  len = parseHex(text, buf, sizeof(buf));
+    if (len == 0) return true;   // baris kosong
+
+    TelemetryStatus   st;
+    TelemetryCounters ct;
+    if (telemetryDecodeStatus(buf, len, st)) {
+        telemetryPrintStatus(stdout, st);
+        return true;
+    }
+    if (telemetryDecodeCounters(buf, len, ct)) {
+        telemetryPrintCounters(stdout, ct);
+        return true;
+    }
+
+    fprintf(stderr, "!! record tidak dikenal (%zu byte, tipe %u versi %u)\n",
+            len, buf[0], len > 1 ? buf[1] : 0);
+    return false;
+}
+
+int main(int argc, char** argv) {
+    int rc = 0;
+
+    if (argc > 1) {
+        for (int i = 1; i < argc; ++i) {
+            if (!decodeLine(argv[i])) rc = 1;
+        }
+        return rc;
+    }
+
+    char line[512];
+    while (fgets(line, sizeof(line), stdin)) {
+        if (!decodeLine(line)) rc = 1;
+    }
+    return rc;
+}
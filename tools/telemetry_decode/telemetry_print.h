@@ -0,0 +1,36 @@
+#pragma once
+// Cetak record telemetry yang sudah di-decode; dipakai telemetry_decode
+// dan telemetry_loopback supaya format output sama.
+#include <cstdio>
+#include "Telemetry.h"
+
+static inline void telemetryPrintStatus(FILE* f, const TelemetryStatus& s) {
+    fprintf(f, "STATUS   %s%s%s%s%s%s%s",
+            s.flags & TELEMETRY_F_CONNECTED  ? "CONN "   : "",
+            s.flags & TELEMETRY_F_NEAR       ? "NEAR "   : "",
+            s.flags & TELEMETRY_F_CONTACT    ? "CONTACT ": "",
+            s.flags & TELEMETRY_F_SCAN_SLOW  ? "SLOW "   : "AGGR ",
+            s.flags & TELEMETRY_F_BATT_LOW   ? "BATTLOW ": "",
+            s.flags & TELEMETRY_F_MANUAL     ? "MANUAL " : "",
+            s.flags & TELEMETRY_F_CALIBRATED ? "CAL "    : "");
+
+    if (s.rssiAvg == TELEMETRY_RSSI_NONE) fprintf(f, "rssi=- ");
+    else                                  fprintf(f, "rssi=%d ", s.rssiAvg);
+    fprintf(f, "near>=%d far<=%d ", s.nearDbm, s.farDbm);
+
+    if (s.batteryPercent == TELEMETRY_BATTERY_UNKNOWN) fprintf(f, "batt=- ");
+    else                                               fprintf(f, "batt=%u%% ", s.batteryPercent);
+
+    fprintf(f, "sesi=%u key=%d manual=%s act=%u\n",
+            s.sessionCount, s.nearestKey, s.manualState ? "CODE" : "idle",
+            s.activationCount);
+}
+
+static inline void telemetryPrintCounters(FILE* f, const TelemetryCounters& c) {
+    fprintf(f, "COUNTERS boot=%u conn=%u disc=%u fail=%u spvn=%u unlock=%u trig=%u "
+               "click=%u lateMax=%luus notify=%lu heap=%lu up=%lus\n",
+            c.bootCount, c.connects, c.disconnects, c.connectFails, c.supervisionTimeouts,
+            c.unlocks, c.triggerPresses, c.itagClicks,
+            (unsigned long)c.contactLateMaxUs, (unsigned long)c.notifies,
+            (unsigned long)c.freeHeap, (unsigned long)c.uptimeS);
+}
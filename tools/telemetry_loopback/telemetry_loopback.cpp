@@ -0,0 +1,230 @@
+// ======================================================================
+//  HOST TELEMETRY LOOPBACK
+//  Pengganti HP servis untuk tes tanpa hardware: skenario state firmware
+//  dijalankan di waktu virtual dengan loop() tiap 5 ms, record di-encode +
+//  di-coalesce persis seperti updateTelemetry(), lalu "notify" diterima
+//  client lokal yang men-decode dan mengecek:
+//    - jarak antar notify status >= 200 ms, counters >= 1000 ms
+//    - tidak ada jeda > heartbeat (5 s) + 1 periode loop
+//    - state terakhir selalu sampai paling lambat 200 ms + 1 loop
+//
+//  Build (dari root repo):
+//    g++ -std=c++17 -O2 -Ilib/Telemetry -Itools/telemetry_decode
+//        tools/telemetry_loopback/telemetry_loopback.cpp lib/Telemetry/Telemetry.cpp
+//        -o telemetry_loopback
+//  Pakai:
+//    ./telemetry_loopback        → ringkasan + PASS/FAIL
+//    ./telemetry_loopback -v     → plus setiap record yang diterima client
+// ======================================================================
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include "Telemetry.h"
+#include "telemetry_print.h"
+
+// Sama dengan firmware (src/main.cpp)
+static const uint16_t STATUS_MIN_MS   = 200;
+static const uint16_t COUNTERS_MIN_MS = 1000;
+static const uint16_t HEARTBEAT_MS    = 5000;
+static const uint32_t LOOP_MS         = 5;
+static const uint32_t RUN_MS          = 60000;
+
+// Client lokal: terima notify, decode, cek laju.
+struct StandInClient {
+    const char* name;
+    uint16_t    minGapMs;
+    bool        verbose;
+
+    uint32_t received   = 0;
+    uint32_t lastRxMs   = 0;
+    uint32_t minGapSeen = 0xFFFFFFFF;
+    uint32_t maxGapSeen = 0;
+    uint8_t  last[TELEMETRY_MAX_LEN] = {};
+    size_t   lastLen    = 0;
+    int      fails      = 0;
+
+    void onNotify(uint32_t nowMs, const uint8_t* buf, size_t len) {
+        if (received > 0) {
+            uint32_t gap = nowMs - lastRxMs;
+            if (gap < minGapSeen) minGapSeen = gap;
+            if (gap > maxGapSeen) maxGapSeen = gap;
+        }
+        received++;
+        lastRxMs = nowMs;
+        memcpy(last, buf, len);
+        lastLen = len;
+
+        TelemetryStatus   st;
+        TelemetryCounters ct;
+        bool ok = telemetryDecodeStatus(buf, len, st) || telemetryDecodeCounters(buf, len, ct);
+        if (!ok) {
+            printf("  FAIL %s: record @%u ms tidak bisa di-decode\n", name, nowMs);
+            ++fails;
+            return;
+        }
+        if (verbose) {
+            printf("%8u ms  ", nowMs);
+            if (buf[0] == TELEMETRY_TYPE_STATUS) telemetryPrintStatus(stdout, st);
+            else                                 telemetryPrintCounters(stdout, ct);
+        }
+    }
+};
+
+// State firmware yang disimulasikan
+struct FakeFirmware {
+    TelemetryStatus   st = {};
+    TelemetryCounters ct = {};
+    uint32_t          stateChanges = 0;
+
+    void begin() {
+        st.rssiAvg        = TELEMETRY_RSSI_NONE;
+        st.nearDbm        = -71;
+        st.farDbm         = -72;
+        st.batteryPercent = TELEMETRY_BATTERY_UNKNOWN;
+        st.nearestKey     = -1;
+        ct.bootCount      = 7;
+        ct.freeHeap       = 180000;
+    }
+
+    // Skenario: key datang, mendekat, unlock, input kode manual cepat, pergi.
+    void step(uint32_t nowMs) {
+        TelemetryStatus before = st;
+
+        if (nowMs == 2000) {
+            st.flags |= TELEMETRY_F_CONNECTED;
+            st.sessionCount = 1;
+            st.nearestKey   = 0;
+            st.rssiAvg      = -100;
+            ct.connects++;
+        }
+        // RSSI EMA per detik, mendekat lalu menjauh
+        if (nowMs >= 3000 && nowMs < 40000 && nowMs % 1000 == 0) {
+            int target = nowMs < 20000 ? -65 : -95;
+            st.rssiAvg = (int8_t)(st.rssiAvg + (target - st.rssiAvg) / 5);
+            if (!(st.flags & TELEMETRY_F_NEAR) && st.rssiAvg >= st.nearDbm) st.flags |= TELEMETRY_F_NEAR;
+            if ((st.flags & TELEMETRY_F_NEAR) && st.rssiAvg <= st.farDbm)  st.flags &= ~TELEMETRY_F_NEAR;
+        }
+        if (nowMs == 4000) st.batteryPercent = 87;
+        if (nowMs == 12000) {
+            ct.triggerPresses++;
+            ct.unlocks++;
+            st.flags |= TELEMETRY_F_CONTACT;
+        }
+        if (nowMs == 15000) st.flags &= ~TELEMETRY_F_CONTACT;
+
+        // Input kode manual: klik tiap 60 ms → banyak perubahan rapat
+        if (nowMs >= 16000 && nowMs < 16000 + 12 * 60 && (nowMs - 16000) % 60 == 0) {
+            ct.triggerPresses++;
+            if (st.activationCount < 3) {
+                st.activationCount++;
+                if (st.activationCount == 3) st.flags |= TELEMETRY_F_MANUAL;
+            } else {
+                st.manualState = 1;
+            }
+        }
+        if (nowMs == 18000) {
+            st.manualState = 0;
+            st.activationCount = 0;
+            st.flags &= ~TELEMETRY_F_MANUAL;
+        }
+
+        if (nowMs == 41000) {
+            st.flags &= ~(TELEMETRY_F_CONNECTED | TELEMETRY_F_NEAR);
+            st.sessionCount = 0;
+            st.nearestKey   = -1;
+            st.rssiAvg      = TELEMETRY_RSSI_NONE;
+            ct.disconnects++;
+            ct.supervisionTimeouts++;
+        }
+        if (nowMs == 41000 + 30000) st.flags |= TELEMETRY_F_SCAN_SLOW;
+
+        ct.uptimeS  = nowMs / 1000;
+        ct.freeHeap = 180000 - (nowMs / 7) % 64;   // heap bergoyang, tidak boleh memicu notify
+
+        if (memcmp(&before, &st, sizeof(st)) != 0) stateChanges++;
+    }
+};
+
+static int checkClient(const StandInClient& c, const uint8_t* finalRec, size_t finalLen,
+                       uint32_t lastChangeMs, uint16_t cmpLen)
+{
+    int fails = c.fails;
+    if (c.received == 0) {
+        printf("  FAIL %s: tidak ada notify\n", c.name);
+        return fails + 1;
+    }
+    if (c.minGapSeen < c.minGapMs) {
+        printf("  FAIL %s: jeda minimum %u ms < %u ms\n", c.name, c.minGapSeen, c.minGapMs);
+        ++fails;
+    }
+    if (c.maxGapSeen > HEARTBEAT_MS + LOOP_MS) {
+        printf("  FAIL %s: jeda maksimum %u ms > heartbeat\n", c.name, c.maxGapSeen);
+        ++fails;
+    }
+    if (c.lastLen != finalLen || memcmp(c.last, finalRec, cmpLen) != 0) {
+        printf("  FAIL %s: state terakhir tidak sampai ke client\n", c.name);
+        ++fails;
+    } else if (c.lastRxMs < lastChangeMs) {
+        printf("  FAIL %s: notify terakhir sebelum perubahan terakhir\n", c.name);
+        ++fails;
+    }
+    return fails;
+}
+
+int main(int argc, char** argv) {
+    bool verbose = argc > 1 && strcmp(argv[1], "-v") == 0;
+
+    FakeFirmware fw;
+    fw.begin();
+
+    TelemetryCoalescer statusCo, countersCo;
+    statusCo.begin(STATUS_MIN_MS, HEARTBEAT_MS, TELEMETRY_STATUS_LEN);
+    countersCo.begin(COUNTERS_MIN_MS, HEARTBEAT_MS, TELEMETRY_COUNTERS_CMP);
+
+    StandInClient statusClient{ "status", STATUS_MIN_MS, verbose };
+    StandInClient countersClient{ "counters", COUNTERS_MIN_MS, verbose };
+
+    uint8_t  buf[TELEMETRY_MAX_LEN];
+    uint8_t  lastStatus[TELEMETRY_MAX_LEN] = {};
+    uint32_t lastStatusChangeMs = 0;
+    size_t   len = 0;
+
+    for (uint32_t now = 0; now <= RUN_MS + 45000; now += LOOP_MS) {
+        fw.step(now);
+
+        // == updateTelemetry() ==
+        len = telemetryEncodeStatus(fw.st, buf);
+        if (memcmp(buf, lastStatus, len) != 0) {
+            memcpy(lastStatus, buf, len);
+            lastStatusChangeMs = now;
+        }
+        if (statusCo.offer(now, buf, (uint8_t)len)) {
+            statusClient.onNotify(now, buf, len);
+            fw.ct.notifies++;
+        }
+
+        len = telemetryEncodeCounters(fw.ct, buf);
+        if (countersCo.offer(now, buf, (uint8_t)len)) {
+            countersClient.onNotify(now, buf, len);
+            fw.ct.notifies++;
+        }
+    }
+
+    uint8_t finalCounters[TELEMETRY_MAX_LEN];
+    size_t  finalCountersLen = telemetryEncodeCounters(fw.ct, finalCounters);
+
+    int fails = 0;
+    fails += checkClient(statusClient, lastStatus, TELEMETRY_STATUS_LEN,
+                         lastStatusChangeMs, TELEMETRY_STATUS_LEN);
+    fails += checkClient(countersClient, finalCounters, finalCountersLen,
+                         0, TELEMETRY_COUNTERS_CMP);
+
+    uint32_t loops = (RUN_MS + 45000) / LOOP_MS + 1;
+    printf("loop %u x, perubahan status %u → notify status %u (jeda %u..%u ms), "
+           "counters %u (jeda %u..%u ms)\n",
+           loops, fw.stateChanges,
+           statusClient.received, statusClient.minGapSeen, statusClient.maxGapSeen,
+           countersClient.received, countersClient.minGapSeen, countersClient.maxGapSeen);
+    printf("%s (%d gagal)\n", fails ? "FAIL" : "PASS", fails);
+    return fails ? 1 : 0;
+}